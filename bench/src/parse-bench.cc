@@ -0,0 +1,243 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#include "cparseparse/argument-parser.h"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif /* defined(__GNUC__) */
+
+/** Number of allocations made through operator new */
+static std::atomic<std::size_t> allocation_count{0};
+
+/**
+ * Counted std::malloc()/std::free() pair behind every replaced operator new
+ * and delete. Kept out of line so that the compiler does not see a new
+ * expression released by free() after inlining.
+ */
+BENCH_NOINLINE static void *counted_malloc(std::size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+BENCH_NOINLINE static void counted_free(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void *operator new(std::size_t size) {
+	return counted_malloc(size);
+}
+
+void *operator new[](std::size_t size) {
+	return counted_malloc(size);
+}
+
+void operator delete(void *ptr) noexcept {
+	counted_free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	counted_free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	counted_free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	counted_free(ptr);
+}
+
+/** Optional argument type alias */
+using Opt_Type = cpparse::Optional_Info::Type;
+
+/** Approximate number of arguments parsed per measurement */
+static const std::size_t TARGET_ARGS{4000000};
+
+/**
+ * Command-line argument strings with an argv array referring to them.
+ */
+class Command_Line {
+public:
+	Command_Line() {
+		add("parse-bench");
+	}
+
+	void add(std::string arg) {
+		m_storage.push_back(std::move(arg));
+	}
+
+	const std::vector<const char *> &argv() {
+		m_argv.clear();
+		for (const auto &arg : m_storage)
+			m_argv.push_back(arg.c_str());
+		return m_argv;
+	}
+
+private:
+	std::vector<std::string> m_storage;
+	std::vector<const char *> m_argv;
+};
+
+/**
+ * @return the peak resident set size of the process in KiB; each scenario runs
+ *         in its own process, so this is the peak of that scenario
+ */
+static long peak_rss_kib() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/**
+ * Time repeated calls of @a run, each processing @a argc arguments, and print
+ * the result row.
+ */
+template<class Run>
+static void measure(const std::string &scenario, std::size_t argc, Run &&run) {
+	const std::size_t iterations = argc < TARGET_ARGS ? TARGET_ARGS / argc : 1;
+	run();
+
+	using Clock = std::chrono::steady_clock;
+	const auto allocations = allocation_count.load(std::memory_order_relaxed);
+	const auto tstart = Clock::now();
+	for (std::size_t i = 0; i < iterations; ++i)
+		run();
+	const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - tstart).count();
+	const auto allocations_per_run = static_cast<double>(allocation_count.load(std::memory_order_relaxed) - allocations) / iterations;
+
+	std::printf("%-32s %9zu %10.2f %14.1f %16ld\n", scenario.c_str(), argc,
+			static_cast<double>(elapsed) / (static_cast<double>(iterations) * argc), allocations_per_run, peak_rss_kib());
+}
+
+/**
+ * Run one scenario, setup included, in a child process, so that its peak
+ * resident set size is not inflated by the scenarios before it.
+ */
+template<class Scenario>
+static void isolate(Scenario &&scenario) {
+	std::fflush(stdout);
+	const auto pid = fork();
+	if (pid < 0) {
+		std::perror("fork");
+		std::exit(1);
+	}
+	if (pid == 0) {
+		scenario();
+		std::fflush(stdout);
+		_exit(0);
+	}
+	int status;
+	if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		std::fprintf(stderr, "scenario process failed\n");
+		std::exit(1);
+	}
+}
+
+/**
+ * Measure parse_args() on the command line, restoring argv before every call.
+ */
+static void measure_parse(const std::string &scenario, cpparse::Argument_Parser &parser, Command_Line &line) {
+	const auto &argv = line.argv();
+	std::vector<const char *> scratch(argv.size());
+	measure(scenario, argv.size(), [&]() {
+		std::copy(argv.begin(), argv.end(), scratch.begin());
+		int argc = scratch.size();
+		auto args = scratch.data();
+		parser.parse_args(argc, args);
+	});
+}
+
+static void bench_option_count() {
+	for (const std::size_t count : {10, 100, 1000, 5000}) isolate([count]() {
+		cpparse::Argument_Parser parser{cpparse::Argument_Parser::Options{}.auto_help(false)};
+		Command_Line line;
+		for (std::size_t i = 0; i < count; ++i) {
+			const auto name = "--opt" + std::to_string(i);
+			parser.add_optional(name, Opt_Type::SINGLE);
+			line.add(name);
+			line.add(std::to_string(i));
+		}
+		measure_parse("options=" + std::to_string(count), parser, line);
+	});
+}
+
+static void bench_argv_length() {
+	for (const std::size_t length : {10, 1000, 100000, 1000000}) isolate([length]() {
+		cpparse::Argument_Parser parser{cpparse::Argument_Parser::Options{}.auto_help(false)};
+		parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+		parser.add_optional("-o", "--output", Opt_Type::SINGLE);
+		parser.add_positional("input");
+		Command_Line line;
+		line.add("-v");
+		line.add("-o");
+		line.add("out.txt");
+		for (std::size_t i = 4; i < length; ++i)
+			line.add("path/to/file" + std::to_string(i));
+		measure_parse("argv=" + std::to_string(length), parser, line);
+	});
+}
+
+static void bench_append() {
+	for (const std::size_t length : {10, 1000, 100000, 1000000}) isolate([length]() {
+		cpparse::Argument_Parser parser{cpparse::Argument_Parser::Options{}.auto_help(false)};
+		parser.add_optional("-a", "--append", Opt_Type::APPEND);
+		Command_Line line;
+		for (std::size_t i = 1; i + 1 < length; i += 2) {
+			line.add("-a");
+			line.add(std::to_string(i));
+		}
+		measure_parse("append argv=" + std::to_string(length), parser, line);
+	});
+}
+
+static void bench_typed_retrieval() {
+	for (const std::size_t length : {10, 1000, 100000}) isolate([length]() {
+		cpparse::Argument_Parser parser{cpparse::Argument_Parser::Options{}.auto_help(false)};
+		const auto append = parser.add_optional("-a", "--append", Opt_Type::APPEND).handle<int>();
+		Command_Line line;
+		for (std::size_t i = 1; i + 1 < length; i += 2) {
+			line.add("-a");
+			line.add(std::to_string(i));
+		}
+		const auto &argv = line.argv();
+		std::vector<const char *> scratch(argv.size());
+		std::size_t total{0};
+		measure("parse+args<int>() argv=" + std::to_string(length), argv.size(), [&]() {
+			std::copy(argv.begin(), argv.end(), scratch.begin());
+			int argc = scratch.size();
+			auto args = scratch.data();
+			parser.parse_args(argc, args);
+			total += parser.args(append).size();
+		});
+		if (total == 0)
+			std::printf("unexpected empty result\n");
+	});
+}
+
+int main() {
+	std::printf("cparseparse parse benchmark (__cplusplus=%ld)\n\n", static_cast<long>(__cplusplus));
+	std::printf("%-32s %9s %10s %14s %16s\n", "scenario", "argc", "ns/arg", "allocs/parse", "peak RSS (KiB)");
+	bench_option_count();
+	bench_argv_length();
+	bench_append();
+	bench_typed_retrieval();
+	return 0;
+}
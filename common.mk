@@ -11,6 +11,7 @@ STD := c++11
 CC := g++
 CPPFLAGS := -I../include
 CXXFLAGS := -Wall -Wextra -std=$(STD)
+LDFLAGS := -pthread
 
 ifeq ($(BUILD),debug)
 CXXFLAGS += -O0 -g
@@ -20,6 +21,13 @@ else
 $(error BUILD must be either 'debug' or 'release')
 endif
 
+# Compiled library mode: build against lib/libcparseparse.a instead of
+# compiling the parser into every translation unit
+ifeq ($(COMPILED_LIB),1)
+override CPPFLAGS += -DCPPARSE_COMPILED_LIB
+LDLIBS := ../lib/libcparseparse.a
+endif
+
 ifeq ($(CDIR),)
 $(error CDIR must be defined)
 endif
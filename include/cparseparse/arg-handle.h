@@ -0,0 +1,68 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_ARG_HANDLE_H_
+#define CPARSEPARSE_ARG_HANDLE_H_
+
+#include <cstddef>
+
+namespace cpparse {
+
+	/**
+	 * Lightweight typed reference to an argument definition.
+	 *
+	 * A handle stores the argument's definition index and kind, allowing
+	 * Argument_Parser to answer queries with direct indexed access instead of a
+	 * name lookup. Handles are obtained from Optional_Info::handle() or
+	 * Positional_Info::handle() and are only meaningful for the parser that
+	 * defined the argument.
+	 *
+	 * @tparam T  type that the argument values are retrieved as
+	 */
+	template<class T>
+	class Arg_Handle {
+	public:
+
+		/** Type that the argument values are retrieved as */
+		using Value = T;
+
+		/**
+		 * Argument kind.
+		 */
+		enum class Kind { OPTIONAL, POSITIONAL };
+
+		/**
+		 * Construct handle.
+		 *
+		 * @param kind   argument kind
+		 * @param index  argument definition index within its kind
+		 */
+		constexpr Arg_Handle(Kind kind, std::size_t index) noexcept
+				: m_kind{kind},
+				  m_index{index} { }
+
+		/**
+		 * @return the argument kind
+		 */
+		constexpr Kind kind() const noexcept {
+			return m_kind;
+		}
+
+		/**
+		 * @return the argument definition index within its kind
+		 */
+		constexpr std::size_t index() const noexcept {
+			return m_index;
+		}
+
+	private:
+		Kind m_kind;
+		std::size_t m_index;
+	};
+
+}
+
+#endif /* CPARSEPARSE_ARG_HANDLE_H_ */
@@ -7,15 +7,53 @@
 #ifndef CPARSEPARSE_ARGUMENT_INFO_H_
 #define CPARSEPARSE_ARGUMENT_INFO_H_
 
+#include "cparseparse/arg-handle.h"
+#include "cparseparse/parse-state.h"
+#include "cparseparse/parse-status.h"
+#include "cparseparse/util/convert.h"
 #include "cparseparse/util/errstr.h"
-#include "cparseparse/util/string-ops.h"
-#include <iomanip>
-#include <iostream>
+#include "cparseparse/util/string-view.h"
+#include "cparseparse/util/value-cache.h"
+#include <cstdint>
 #include <limits>
+#include <stdexcept>
 #include <string>
 
 namespace cpparse {
 
+	/**
+	 * Format the error message for a failed conversion of the named argument to
+	 * type T.
+	 */
+	template<class T>
+	typename std::enable_if<std::is_same<T, bool>::value, std::string>::type conversion_error(String_View script_name, String_View name, Convert_Error) {
+		return errstr(script_name, "'", name, "' must be one of: 'true', 'false', 'yes', 'no', 'on', 'off'");
+	}
+	template<class T>
+	typename std::enable_if<std::is_same<T, char>::value, std::string>::type conversion_error(String_View script_name, String_View name, Convert_Error) {
+		return errstr(script_name, "'", name, "' must be a single character");
+	}
+	template<class T>
+	typename std::enable_if<!std::is_same<T, bool>::value && !std::is_same<T, char>::value && std::is_integral<T>::value, std::string>::type conversion_error(String_View script_name, String_View name, Convert_Error err) {
+		if (err == Convert_Error::INVALID)
+			return errstr(script_name, "'", name, "' must be of integral type");
+		return errstr(script_name, "'", name, "' must be in range [", std::numeric_limits<T>::min(), ",", std::numeric_limits<T>::max(), "]");
+	}
+	template<class T>
+	typename std::enable_if<std::is_floating_point<T>::value, std::string>::type conversion_error(String_View script_name, String_View name, Convert_Error err) {
+		if (err == Convert_Error::INVALID)
+			return errstr(script_name, "'", name, "' must be of floating-point type");
+		return errstr(script_name, "'", name, "' must be in range [", std::numeric_limits<T>::lowest(), ",", std::numeric_limits<T>::max(), "]");
+	}
+	template<class T>
+	typename std::enable_if<!std::is_arithmetic<T>::value && !_convert_has_error<T>::value, std::string>::type conversion_error(String_View script_name, String_View name, Convert_Error) {
+		return errstr(script_name, "'", name, "' has an invalid value");
+	}
+	template<class T>
+	typename std::enable_if<_convert_has_error<T>::value, std::string>::type conversion_error(String_View script_name, String_View name, Convert_Error err) {
+		return errstr(script_name, converter<T>::error(name, err));
+	}
+
 	/**
 	 * Argument info object storing information about a generic argument.
 	 */
@@ -30,7 +68,8 @@ namespace cpparse {
 		 */
 		template<class String>
 		explicit Argument_Info(String &&name) noexcept(std::is_nothrow_constructible<std::string, String &&>::value)
-				: m_name{std::forward<String>(name)} { }
+				: m_name{std::forward<String>(name)},
+				  m_index{0} { }
 
 		/**
 		 * Default virtual destructor.
@@ -67,6 +106,7 @@ namespace cpparse {
 		template<class String>
 		Argument_Type &help(String &&help_text) noexcept(std::is_nothrow_assignable<std::string, String &&>::value) {
 			m_help_text = std::forward<String>(help_text);
+			touch();
 			return reinterpret_cast<Argument_Type &>(*this);
 		}
 
@@ -74,85 +114,122 @@ namespace cpparse {
 
 		std::string m_name;
 		std::string m_help_text;
+		std::size_t m_index;
+		std::uint64_t *m_revision{nullptr};
 
 		/**
-		 * Print the argument name and help text.
-		 *
-		 * @param text_width  text width spacing
-		 * @param out         output stream
+		 * Record a change to the properties shown in the help text, so that the
+		 * owning parser renders it again.
 		 */
-		void print_help(std::size_t text_width, std::ostream &out = std::cout) const {
-			print_help(m_name, text_width, out);
+		void touch() noexcept {
+			if (m_revision)
+				++*m_revision;
 		}
 
+		/* Private functions for Argument_Parser */
+
 		/**
-		 * Print the argument name and help text.
+		 * Set the counter that touch() advances.
 		 *
-		 * @param name        argument name
-		 * @param text_width  text width spacing
-		 * @param out         output stream
+		 * @param revision  help text revision of the owning parser's schema
 		 */
-		void print_help(const std::string &name, std::size_t text_width, std::ostream &out = std::cout) const {
-			out << "  " << std::left << std::setw(text_width - 2) << name << m_help_text << std::endl;
+		void set_revision(std::uint64_t &revision) noexcept {
+			m_revision = &revision;
 		}
 
 		/**
 		 * Parse the argument as type T.
 		 *
-		 * Valid choices for T are booleans, unsigned/signed integer types, floating point types, and std::string.
+		 * Valid choices for T are booleans, unsigned/signed integer types, floating point types, std::string,
+		 * String_View, and types with a converter specialization. A String_View result refers to the stored
+		 * value without copying it.
 		 *
-		 * @tparam T     type to parse the argument as
-		 * @param value  the argument value as a string
+		 * @tparam T       type to parse the argument as
+		 * @param context  context of the parse that matched the value
+		 * @param value    the argument value
 		 * @return the argument parsed as type T
+		 * @throw std::runtime_error  if the argument cannot be parsed as type @a T
 		 */
 		template<class T>
-		typename std::enable_if<std::is_same<T, bool>::value, T>::type parse_as_type(const std::string &value) const {
-			if (value == "true" || value == "yes" || value == "on")
-				return true;
-			else if (value == "false" || value == "no" || value == "off")
-				return false;
-			throw std::runtime_error{errstr("'", m_name, "' must be one of: 'true', 'false', 'yes', 'no', 'on', 'off'")};
-		}
-		template<class T>
-		typename std::enable_if<std::is_same<T, char>::value, T>::type parse_as_type(const std::string &value) const {
-			if (value.size() != 1)
-				throw std::runtime_error{errstr("'", m_name, "' must be a single character")};
-			return value[0];
-		}
-		template<class T>
-		typename std::enable_if<!std::is_same<T, bool>::value && std::is_integral<T>::value && std::is_unsigned<T>::value, T>::type parse_as_type(const std::string &value) const {
-			return parse_numeric_arg<T>(value, [](const std::string &value) { return cpparse::stoull(value); });
-		}
-		template<class T>
-		typename std::enable_if<!std::is_same<T, char>::value && std::is_integral<T>::value && std::is_signed<T>::value, T>::type parse_as_type(const std::string &value) const {
-			return parse_numeric_arg<T>(value, [](const std::string &value) { return std::stoll(value); });
+		T parse_as_type(const Parse_Context &context, String_View value) const {
+			CPPARSE_OBSERVE_CONVERSION(context, m_name, 1);
+			auto out = _convert_target<T>();
+			const auto err = convert_value<T>(value, out);
+			if (err != Convert_Error::NONE)
+				CPPARSE_THROW(std::runtime_error{conversion_error<T>(context.script_name, m_name, err)});
+			return out;
 		}
+
+		/**
+		 * Parse the argument values as type T, reusing the result of any previous
+		 * conversion to the same type.
+		 *
+		 * @tparam T       type to parse the argument as
+		 * @param context  context of the parse that matched the values
+		 * @param cache    conversion cache for the values
+		 * @param values   argument values
+		 * @param count    number of argument values
+		 * @return the argument values parsed as type T
+		 */
 		template<class T>
-		typename std::enable_if<std::is_floating_point<T>::value, T>::type parse_as_type(const std::string &value) const {
-			return parse_numeric_arg<T>(value, [](const std::string &value) { return std::stold(value); });
+		const Cached_Values<T> &cached_values(const Parse_Context &context, const Value_Cache &cache, const String_View *values, std::size_t count) const {
+			const auto cached = cache.find<T>();
+			if (cached)
+				return *cached;
+
+			CPPARSE_OBSERVE_CONVERSION(context, m_name, count);
+			Cached_Values<T> converted{count, cache.resource()};
+			auto out = _convert_target<T>();
+			for (std::size_t i = 0; i < count; ++i) {
+				if (convert_value<T>(values[i], out) == Convert_Error::NONE)
+					converted.add(std::move(out));
+				else
+					converted.add_failed();
+			}
+			return cache.insert(std::move(converted));
 		}
+
+		/**
+		 * Parse the argument value at the given index as type T, reusing the result
+		 * of any previous conversion to the same type.
+		 *
+		 * @tparam T       type to parse the argument as
+		 * @param context  context of the parse that matched the values
+		 * @param cache    conversion cache for the values
+		 * @param values   argument values
+		 * @param count    number of argument values
+		 * @param idx      index of the value to parse
+		 * @return the argument value parsed as type T
+		 * @throw std::runtime_error  if the value cannot be parsed as type @a T
+		 */
 		template<class T>
-		typename std::enable_if<std::is_same<T, std::string>::value, T>::type parse_as_type(std::string value) const noexcept {
-			return value;
+		T cached_as_type(const Parse_Context &context, const Value_Cache &cache, const String_View *values, std::size_t count, std::size_t idx) const {
+			const auto &cached = cached_values<T>(context, cache, values, count);
+			if (!cached.converted(idx))
+				return parse_as_type<T>(context, values[idx]);
+			return cached.value(idx);
 		}
 
-	private:
-
 		/**
-		 * Parse the string argument as a numeric of type T.
+		 * Parse the argument value at the given index as type T without throwing,
+		 * reusing the result of any previous conversion to the same type.
+		 *
+		 * @see cached_as_type()
+		 *
+		 * @param out  converted value; only assigned on success
+		 * @return the conversion status
 		 */
-		template<class T, class Convert_Func>
-		T parse_numeric_arg(const std::string &value, Convert_Func &&convert_func) const {
-			try {
-				const auto n_value = convert_func(value);
-				if (n_value < std::numeric_limits<T>::lowest() || n_value > std::numeric_limits<T>::max())
-					throw std::out_of_range{""};
-				return n_value;
-			} catch (const std::invalid_argument &ex) {
-				throw std::runtime_error{errstr("'", m_name, "' must be of integral type")};
-			} catch (const std::out_of_range &ex) {
-				throw std::runtime_error{errstr("'", m_name, "' must be in range [", std::numeric_limits<T>::min(), ",", std::numeric_limits<T>::max(), "]")};
+		template<class T>
+		Parse_Status try_cached_as_type(const Parse_Context &context, const Value_Cache &cache, const String_View *values, std::size_t count, std::size_t idx, T &out) const {
+			const auto &cached = cached_values<T>(context, cache, values, count);
+			if (cached.converted(idx)) {
+				out = cached.value(idx);
+				return Parse_Status{};
 			}
+			auto value = _convert_target<T>();
+			return Parse_Status{Parse_Errc::CONVERSION, context.script_name, -1}
+					.with_argument(m_index, m_name)
+					.with_conversion(convert_value<T>(values[idx], value), &conversion_error<T>);
 		}
 
 	};
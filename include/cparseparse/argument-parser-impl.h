@@ -0,0 +1,726 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_ARGUMENT_PARSER_IMPL_H_
+#define CPARSEPARSE_ARGUMENT_PARSER_IMPL_H_
+
+/*
+ * Out-of-line definitions of the Argument_Parser functions that do not depend
+ * on user types. Included by argument-parser.h in header-only builds, or
+ * compiled once into libcparseparse.a when CPPARSE_COMPILED_LIB is defined.
+ */
+
+#include "cparseparse/argument-parser.h"
+#include "cparseparse/util/config-lexer.h"
+#include "cparseparse/util/environment.h"
+#include "cparseparse/util/response-file.h"
+#include "cparseparse/util/snapshot.h"
+#include "cparseparse/util/string-ops.h"
+#include "cparseparse/util/terminal.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+namespace cpparse {
+
+	CPPARSE_INLINE void Argument_Parser::print_completions(int argc, const char *const *argv) {
+		print_completions(argc, argv, std::cout);
+	}
+
+	CPPARSE_INLINE void Argument_Parser::print_usage() const {
+		print_usage(std::cout);
+	}
+
+	CPPARSE_INLINE void Argument_Parser::print_help() const {
+		print_help(std::cout);
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::try_parse_args(int &argc, const char **&argv) {
+		if (m_completion && argc > 1 && String_View{argv[1]} == "--cpparse-complete") {
+			complete_request(argc - 2, argv + 2);
+			std::cout.flush();
+			std::exit(0);
+		}
+		m_script_name = argv[0];
+		auto &state = m_result.state();
+		Parse_Status status;
+		CPPARSE_TRY {
+			status = match_args(argc, argv, state, true);
+			if (status) {
+				report_parse(state);
+				if (!state.subcommand.empty())
+					status = dispatch_subcommand(state, argc, argv);
+				else
+					remove_matched(state, state.extra_args.data(), state.extra_args.data() + state.extra_args.size(), argc, argv);
+			}
+		} CPPARSE_CATCH_ALL {
+			state.clear();
+			CPPARSE_RETHROW;
+		}
+		if (!status)
+			state.clear_values();
+		return status;
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::try_parse(int argc, const char *const *argv, Parse_Result &result) const {
+		auto &state = result.state();
+		result.m_schema = m_schema.get();
+		Parse_Status status;
+		CPPARSE_TRY {
+			state.bind(m_schema->positionals.size(), m_schema->optionals.size());
+			status = match_args(argc, argv, state, false);
+			if (status)
+				report_parse(state);
+		} CPPARSE_CATCH_ALL {
+			state.clear();
+			CPPARSE_RETHROW;
+		}
+		if (!status)
+			state.clear_values();
+		return status;
+	}
+
+	CPPARSE_INLINE void Argument_Parser::parse_config_file(const std::string &path) {
+		std::ifstream in{path};
+		if (!in)
+			CPPARSE_THROW(std::runtime_error{errstr(m_result.script_name(), "cannot open configuration file '", path, "'")});
+		parse_config(in, path);
+	}
+
+	CPPARSE_INLINE void Argument_Parser::print_completions(int argc, const char *const *argv, std::ostream &out) {
+		const auto &schema = *m_schema;
+		std::size_t positional_count{0};
+		bool any_positional{false};
+		const Optional_Info *wants_value{nullptr};
+		for (int i = 0; i + 1 < argc; ++i) {
+			if (wants_value) {
+				wants_value = nullptr;
+				continue;
+			}
+			const auto token = lex_token(argv[i]);
+			if (token.kind == Token_Kind::SEPARATOR && !any_positional) {
+				any_positional = true;
+				continue;
+			}
+			if (!any_positional && is_flag_cluster(token, argv[i])) {
+				/* A value attached to the last flag of the cluster leaves nothing to complete */
+				for (auto it = token.name; *it != '\0'; ++it) {
+					const auto c = static_cast<unsigned char>(*it);
+					const auto ref = c < schema.flags.size() ? schema.flags[c] : std::uint32_t{Name_Index::NPOS};
+					if (ref != Name_Index::NPOS && schema.optionals[ref].type() != Optional_Info::Type::FLAG) {
+						if (it[1] == '\0')
+							wants_value = &schema.optionals[ref];
+						break;
+					}
+				}
+				continue;
+			}
+			if (token.is_option() && !any_positional) {
+				const auto ref = token.kind == Token_Kind::FLAG ? schema.flags[token.name[0]] : find_long_option(String_View{token.name, token.length});
+				if (ref < schema.optionals.size() && schema.optionals[ref].type() != Optional_Info::Type::FLAG)
+					wants_value = &schema.optionals[ref];
+				continue;
+			}
+			if (!m_subcommands.empty() && positional_count == schema.positionals.size()) {
+				if (m_subcommand_names.find(argv[i]) != Name_Index::NPOS) {
+					subparser(argv[i]).print_completions(argc - i - 1, argv + i + 1, out);
+					return;
+				}
+			}
+			++positional_count;
+		}
+		const String_View word{argc > 0 ? argv[argc - 1] : ""};
+		std::vector<std::string> matches;
+		if (wants_value) {
+			for (const auto &choice : wants_value->choices()) {
+				if (starts_with(choice, word))
+					matches.push_back(choice);
+			}
+		} else if (!word.empty() && word[0] == '-' && !any_positional) {
+			const bool is_long = word.size() > 1 && word[1] == '-';
+			const String_View prefix{word.data() + (is_long ? 2 : 1), word.size() - (is_long ? 2 : 1)};
+			if (!is_long) {
+				for (const auto &optional : schema.optionals) {
+					if (optional.has_flag() && (prefix.empty() || (prefix.size() == 1 && prefix[0] == optional.flag())))
+						matches.push_back(std::string{'-', optional.flag()});
+				}
+			}
+			if (is_long || prefix.empty()) {
+				const auto last = schema.long_names.prefix_end(prefix);
+				for (auto entry = schema.long_names.prefix_begin(prefix); entry != last; ++entry)
+					matches.push_back("--" + to_string(entry->name));
+			}
+		} else if (!m_subcommands.empty() && positional_count == schema.positionals.size()) {
+			for (const auto &subcommand : m_subcommands) {
+				if (starts_with(subcommand.name, word))
+					matches.push_back(subcommand.name);
+			}
+		}
+		std::sort(matches.begin(), matches.end());
+		std::string text;
+		for (const auto &match : matches)
+			text.append(match).push_back('\n');
+		out.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	/**
+	 * Help text last rendered by print_help(), and what it was rendered from.
+	 */
+	struct Argument_Parser::Help_Cache {
+		std::mutex mutex;
+		std::string text;
+		std::string script_name;
+		std::uint64_t revision{0};
+		std::size_t width{0};
+		bool valid{false};
+	};
+
+	CPPARSE_INLINE Argument_Parser::Help_Cache_Ptr Argument_Parser::make_help_cache() {
+		return Help_Cache_Ptr{new Help_Cache, [](Help_Cache *cache) { delete cache; }};
+	}
+
+	CPPARSE_INLINE void Argument_Parser::print_usage(std::ostream &out) const {
+		std::string text;
+		append_usage(text);
+		out.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	CPPARSE_INLINE void Argument_Parser::print_help(std::ostream &out) const {
+		const auto width = m_help_width == Options::TERMINAL_WIDTH ? terminal_width() : m_help_width;
+		auto &cache = *m_help_cache;
+		std::lock_guard<std::mutex> lock{cache.mutex};
+		if (!cache.valid || cache.revision != m_schema->revision || cache.width != width || cache.script_name != m_script_name) {
+			cache.valid = false;
+			cache.text.clear();
+			append_help(width, cache.text);
+			cache.script_name = m_script_name;
+			cache.revision = m_schema->revision;
+			cache.width = width;
+			cache.valid = true;
+		}
+		out.write(cache.text.data(), static_cast<std::streamsize>(cache.text.size()));
+	}
+
+	CPPARSE_INLINE void Argument_Parser::append_usage(std::string &out) const {
+		out.append("Usage: ").append(m_script_name);
+		if (!m_schema->optionals.empty())
+			out.append(" [options]");
+		for (const auto &positional : m_schema->positionals)
+			out.append(" <").append(positional.name()).push_back('>');
+		if (!m_subcommands.empty())
+			out.append(" <command> [args]");
+		out.push_back('\n');
+	}
+
+	CPPARSE_INLINE void Argument_Parser::append_help(std::size_t width, std::string &out) const {
+		const auto &schema = *m_schema;
+		std::string label, help;
+
+		/* Place the help column after the longest name that leaves it within bounds */
+		std::size_t longest{0};
+		const auto fit = [&longest](std::size_t size) {
+			if (size + 4 <= MAX_HELP_COLUMN && size > longest)
+				longest = size;
+		};
+		for (const auto &positional : schema.positionals)
+			fit(positional.name().size());
+		for (const auto &subcommand : m_subcommands)
+			fit(subcommand.name.size());
+		for (const auto &optional : schema.optionals) {
+			label.clear();
+			optional.append_label(label);
+			fit(label.size());
+		}
+		const auto column = longest + 4;
+		const auto append_entry = [&out, column, width](String_View name, String_View text) {
+			out.append(2, ' ').append(name.data(), name.size());
+			if (!text.empty()) {
+				if (name.size() + 4 > column) {
+					out.push_back('\n');
+					out.append(column, ' ');
+				} else {
+					out.append(column - 2 - name.size(), ' ');
+				}
+				append_wrapped(out, text, column, width);
+			}
+			out.push_back('\n');
+		};
+
+		append_usage(out);
+		if (!m_description.empty()) {
+			out.append("\n  ");
+			append_wrapped(out, m_description, 2, width);
+			out.push_back('\n');
+		}
+		if (!schema.positionals.empty()) {
+			out.append("\nPositional arguments:\n");
+			for (const auto &positional : schema.positionals)
+				append_entry(positional.name(), positional.help());
+		}
+		if (!m_subcommands.empty()) {
+			out.append("\nCommands:\n");
+			for (const auto &subcommand : m_subcommands)
+				append_entry(subcommand.name, subcommand.help);
+		}
+		if (!schema.optionals.empty()) {
+			out.append("\nOptions:\n");
+			for (const auto &optional : schema.optionals) {
+				label.clear();
+				help.clear();
+				optional.append_label(label);
+				optional.append_help(help);
+				append_entry(label, help);
+			}
+		}
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::match_args(int argc, const char *const *argv, Parse_State &state, bool invoke_help) const {
+		const auto &schema = *m_schema;
+		state.clear();
+		observe(state);
+		state.script_name = store_value(state, argv[0], 0);
+		state.invoked_name = argv[0];
+		if (m_response_files) {
+			const auto status = expand_response_files(state, argc, argv);
+			if (!status)
+				return status;
+		}
+		CPPARSE_OBSERVE_PHASE(state, MATCH_ARGS);
+		state.pos_args.reserve(schema.positionals.size());
+		{
+			/* Expanded arguments are views, which need not be null-terminated */
+			const auto status = state.args.empty()
+					? match_tokens(state, argc, argv, invoke_help)
+					: match_tokens(state, static_cast<int>(state.args.size()), state.args.data(), invoke_help);
+			if (!status)
+				return status;
+		}
+		if (schema.env_names.size() > 0) {
+			const auto status = match_env(state);
+			if (!status)
+				return status;
+		}
+		if (state.pos_args.size() < schema.positionals.size()) {
+			if (state.help_requested && !invoke_help)
+				return Parse_Status{};
+			const auto missing = state.pos_args.size();
+			return parse_error(state, Parse_Errc::MISSING_POSITIONAL, -1).with_argument(missing, schema.positionals[missing].name());
+		}
+		assign_matched_pos(state);
+		return Parse_Status{};
+	}
+
+	template<class Arg>
+	Parse_Status Argument_Parser::match_tokens(Parse_State &state, int argc, const Arg *args, bool invoke_help) const {
+		const auto &schema = *m_schema;
+		bool options_ended{false};
+		for (int i = 1; i < argc; ++i) {
+			CPPARSE_COUNT(state, tokens, 1);
+			const auto token = lex_token(args[i]);
+			if (token.kind == Token_Kind::SEPARATOR && !options_ended) {
+				options_ended = true;
+				continue;
+			}
+			if (!options_ended && is_flag_cluster(token, arg_data(args[i]))) {
+				const auto status = match_flag_cluster(state, token, argc, args, i, invoke_help);
+				if (!status)
+					return status;
+				continue;
+			}
+			if (options_ended || !token.is_option()) {
+				if (state.pos_args.size() < schema.positionals.size()) {
+					state.pos_args.push_back(store_value(state, args[i], i));
+					continue;
+				}
+				if (token.kind == Token_Kind::POSITIONAL && !m_subcommands.empty()) {
+					const auto subcommand = m_subcommand_names.find(args[i]);
+					if (subcommand == Name_Index::NPOS)
+						return parse_error(state, Parse_Errc::INVALID_COMMAND, i).with_token(args[i]);
+					state.subcommand = m_subcommands[subcommand].name;
+					for (; i < argc; ++i)
+						state.extra_args.push_back(arg_c_str(state, args, i));
+					break;
+				}
+				state.extra_args.push_back(arg_c_str(state, args, i));
+				continue;
+			}
+
+			std::size_t opt_idx{0};
+			auto status = lookup_option_token(state, token, i, args[i], invoke_help, opt_idx);
+			if (!status)
+				return status;
+			const auto &optional = schema.optionals[opt_idx];
+			auto &values = state.optionals[opt_idx];
+			const auto next_arg = i + 1 < argc ? &args[i + 1] : nullptr;
+			bool consume;
+			status = prematch_optional_arg(state, optional, values, i, next_arg, consume);
+			if (!status)
+				return status;
+			if (consume) {
+				const String_View value{args[++i]};
+				status = add_values(state, optional, values, optional.m_on_value ? value : store_value(state, value, i), i);
+			} else {
+				status = add_values(state, optional, values, "true", i);
+			}
+			if (!status)
+				return status;
+		}
+		return Parse_Status{};
+	}
+
+	template<class Arg>
+	Parse_Status Argument_Parser::match_flag_cluster(Parse_State &state, const Lexed_Token &token, int argc, const Arg *args, int &arg_index, bool invoke_help) const {
+		const auto &schema = *m_schema;
+		const auto last = token.name + token.length;
+		const String_View cluster{token.name - 1, token.length + 1};
+		for (auto it = token.name; it != last; ++it) {
+			const auto c = static_cast<unsigned char>(*it);
+			const auto ref = c < schema.flags.size() ? schema.flags[c] : std::uint32_t{Name_Index::NPOS};
+			if (ref == Name_Index::NPOS)
+				return parse_error(state, Parse_Errc::INVALID_FLAG, arg_index).with_token(String_View{it, 1}).with_detail(cluster);
+			const auto &optional = schema.optionals[ref];
+			auto &values = state.optionals[ref];
+			note_help(state, optional.name(), invoke_help);
+			if (optional.type() == Optional_Info::Type::FLAG) {
+				const auto status = add_values(state, optional, values, "true", arg_index);
+				if (!status)
+					return status;
+				continue;
+			}
+
+			if (it + 1 != last) {
+				if (!repeat_allowed(optional, values))
+					return parse_error(state, Parse_Errc::REPEATED_ARGUMENT, arg_index).with_argument(optional.m_index, optional.name());
+				const String_View value{it + 1, static_cast<std::size_t>(last - it - 1)};
+				return add_values(state, optional, values, optional.m_on_value ? value : store_value(state, value, arg_index), arg_index);
+			}
+			const auto next_arg = arg_index + 1 < argc ? &args[arg_index + 1] : nullptr;
+			bool consume;
+			const auto status = prematch_optional_arg(state, optional, values, arg_index, next_arg, consume);
+			if (!status)
+				return status;
+			const String_View value{args[++arg_index]};
+			return add_values(state, optional, values, optional.m_on_value ? value : store_value(state, value, arg_index), arg_index);
+		}
+		return Parse_Status{};
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::match_env(Parse_State &state) const {
+		CPPARSE_OBSERVE_PHASE(state, READ_ENVIRONMENT);
+		const auto &schema = *m_schema;
+		Parse_Status status;
+		for_each_env([&state, &schema, &status](String_View name, String_View value) {
+			if (!status)
+				return;
+			const auto ref = schema.env_names.find(name);
+			if (ref == Name_Index::NPOS)
+				return;
+			const auto &optional = schema.optionals[ref];
+			auto &values = state.optionals[ref];
+			if (values.occurrences > 0)
+				return;
+			if (optional.type() == Optional_Info::Type::FLAG) {
+				bool set;
+				if (convert_value<bool>(value, set) != Convert_Error::NONE)
+					status = parse_error(state, Parse_Errc::INVALID_ENVIRONMENT, -1).with_token(name).with_argument(ref, optional.name());
+				else if (set)
+					status = add_values(state, optional, values, "true", -1);
+				return;
+			}
+			status = add_values(state, optional, values, value, -1);
+		});
+		return status;
+	}
+
+	CPPARSE_INLINE void Argument_Parser::match_config(std::istream &in, String_View source, Parse_State &state) const {
+		const auto &schema = *m_schema;
+		observe(state);
+		CPPARSE_OBSERVE_PHASE(state, READ_CONFIG);
+		Resource_Vector<char> preset(state.optionals.size(), 0, Resource_Allocator<char>{state.resource});
+		for (std::size_t i = 0; i < preset.size(); ++i)
+			preset[i] = state.optionals[i].occurrences > 0;
+
+		std::string line, prefix, key;
+		std::size_t line_number{0};
+		while (std::getline(in, line)) {
+			++line_number;
+			const auto parsed = lex_config_line(line);
+			switch (parsed.kind) {
+			case Config_Line_Kind::BLANK:
+				continue;
+			case Config_Line_Kind::INVALID:
+				CPPARSE_THROW(std::runtime_error{errstr(state.script_name, source, ":", line_number, ": invalid line '", config_trim(line), "'")});
+			case Config_Line_Kind::SECTION:
+				prefix.assign(parsed.name.data(), parsed.name.size());
+				if (!prefix.empty())
+					prefix += '-';
+				continue;
+			case Config_Line_Kind::ENTRY:
+				break;
+			}
+
+			key.assign(prefix).append(parsed.name.data(), parsed.name.size());
+			const auto ref = schema.names.find(key);
+			if (ref == Name_Index::NPOS || Argument_Schema::is_positional_ref(ref))
+				CPPARSE_THROW(std::runtime_error{errstr(state.script_name, source, ":", line_number, ": invalid option '", key, "'")});
+			if (preset[ref])
+				continue;
+			const auto &optional = schema.optionals[ref];
+			auto &values = state.optionals[ref];
+			if (!parsed.has_value && optional.type() != Optional_Info::Type::FLAG)
+				CPPARSE_THROW(std::runtime_error{errstr(state.script_name, source, ":", line_number, ": '", key, "' requires a value")});
+			if (!repeat_allowed(optional, values))
+				CPPARSE_THROW(std::runtime_error{errstr(state.script_name, source, ":", line_number, ": '", key, "' should only be specified once")});
+			if (values.occurrences == 0)
+				values.cache.clear();
+			auto value = parsed.has_value ? config_value(parsed.value) : String_View{"true"};
+			if (parsed.has_value && !optional.m_on_value) {
+				CPPARSE_COUNT(state, bytes_copied, value.size());
+				value = state.pool.intern(value);
+			}
+			auto status = add_values(state, optional, values, value, -1);
+			if (!status) {
+				status.m_script_name = state.script_name;
+				CPPARSE_THROW(std::runtime_error{status.message()});
+			}
+		}
+		if (in.bad())
+			CPPARSE_THROW(std::runtime_error{errstr(state.script_name, "error reading configuration '", source, "'")});
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::expand_response_files(Parse_State &state, int argc, const char *const *argv) const {
+		int i = 1;
+		while (i < argc && !is_response_file_arg(argv[i]))
+			++i;
+		if (i == argc)
+			return Parse_Status{};
+
+		CPPARSE_OBSERVE_PHASE(state, EXPAND_RESPONSE_FILES);
+		state.args.assign(argv, argv + i);
+		for (int j = 0; j < i; ++j)
+			state.arg_origins.push_back(Arg_Origin{j, Parse_Status::NPOS, true});
+		for (; i < argc; ++i) {
+			const auto status = expand_response_file_arg(state, argv[i], true, i, Parse_Status::NPOS, 0);
+			if (!status) {
+				state.arg_origins.clear();
+				return status;
+			}
+		}
+		return Parse_Status{};
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::expand_response_file_arg(Parse_State &state, String_View arg, bool terminated, int arg_index, std::size_t offset, unsigned depth) const {
+		if (!is_response_file_arg(arg)) {
+			state.args.push_back(arg);
+			state.arg_origins.push_back(Arg_Origin{arg_index, offset, terminated});
+			return Parse_Status{};
+		}
+		const String_View path{arg.data() + 1, arg.size() - 1};
+		if (depth == MAX_RESPONSE_FILE_DEPTH)
+			return Parse_Status{Parse_Errc::RESPONSE_FILE_DEPTH, state.invoked_name, arg_index}.with_file_offset(offset).with_token(path);
+		Mapped_File file{terminated ? path.data() : state.pool.intern(path).data()};
+		if (!file) {
+			state.args.push_back(arg);
+			state.arg_origins.push_back(Arg_Origin{arg_index, offset, terminated});
+			return Parse_Status{};
+		}
+		const auto data = file.data();
+		const auto size = file.size();
+		state.files.push_back(std::move(file));
+		Parse_Status status;
+		tokenize_response_file(data, data + size, [this, &state, &status, arg_index, data, depth](String_View text, std::size_t length) {
+			if (!status)
+				return;
+			const auto token_offset = static_cast<std::size_t>(text.data() - data);
+			if (length == text.size()) {
+				status = expand_response_file_arg(state, text, false, arg_index, token_offset, depth + 1);
+				return;
+			}
+			/* Only arguments with quotes or escapes are copied, to unescape them */
+			CPPARSE_COUNT(state, bytes_copied, length);
+			const auto copy = state.pool.allocate(length);
+			unescape_response_arg(text, copy);
+			status = expand_response_file_arg(state, String_View{copy, length}, true, arg_index, token_offset, depth + 1);
+		});
+		return status;
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::lookup_option_token(Parse_State &state, const Lexed_Token &token, int arg_index, String_View option_name, bool invoke_help, std::size_t &opt_idx) const {
+		const auto &schema = *m_schema;
+		std::uint32_t ref;
+		String_View name;
+		if (token.kind == Token_Kind::FLAG) {
+			ref = schema.flags[token.name[0]];
+			if (ref == Name_Index::NPOS)
+				return parse_error(state, Parse_Errc::INVALID_FLAG, arg_index).with_token(option_name);
+			name = schema.optionals[ref].name();
+		} else {
+			name = String_View{token.name, token.length};
+			ref = find_long_option(name);
+			if (ref == Prefix_Index::AMBIGUOUS)
+				return parse_error(state, Parse_Errc::AMBIGUOUS_OPTION, arg_index).with_token(name).with_names(schema.long_names);
+			if (ref != Name_Index::NPOS && !Argument_Schema::is_positional_ref(ref))
+				name = schema.optionals[ref].name();
+		}
+
+		note_help(state, name, invoke_help);
+		if (ref == Name_Index::NPOS || Argument_Schema::is_positional_ref(ref))
+			return parse_error(state, Parse_Errc::INVALID_OPTION, arg_index).with_token(name).with_names(schema.long_names);
+		opt_idx = ref;
+		return Parse_Status{};
+	}
+
+	CPPARSE_INLINE void Argument_Parser::read_snapshot(const char *data, std::size_t size, Parse_State &state) const {
+		Snapshot_Reader reader{data, size};
+		const auto positional_count = m_schema->positionals.size();
+		const auto optional_count = m_schema->optionals.size();
+		if (reader.read_u32() != SNAPSHOT_MAGIC || reader.read_u32() != SNAPSHOT_VERSION)
+			Snapshot_Reader::throw_invalid();
+		if (reader.read_u64() != m_schema->fingerprint()
+				|| reader.read_u32() != positional_count
+				|| reader.read_u32() != optional_count)
+			CPPARSE_THROW(std::logic_error{lerrstr("parse snapshot does not match the argument definitions")});
+
+		state.bind(positional_count, optional_count);
+		state.clear();
+		state.help_requested = (reader.read_u32() & 1) != 0;
+		state.script_name = reader.read_string();
+		state.subcommand = reader.read_string();
+		for (std::size_t i = 0; i < positional_count; ++i) {
+			const auto value = reader.read_string();
+			state.positionals[i].set_value(value);
+			state.pos_args.push_back(value);
+		}
+		for (std::size_t i = 0; i < optional_count; ++i) {
+			auto &optional = state.optionals[i];
+			const std::size_t occurrences = reader.read_u32();
+			const std::size_t value_count = reader.read_u32();
+			if (value_count > occurrences)
+				Snapshot_Reader::throw_invalid();
+			optional.values.reserve(value_count);
+			const auto &definition = m_schema->optionals[i];
+			for (std::size_t j = 0; j < value_count; ++j) {
+				const auto value = reader.read_string();
+				optional.values.push_back(value);
+				if (definition.has_choices()) {
+					const auto choice = definition.m_choice_index.find(value);
+					if (choice == Name_Index::NPOS)
+						Snapshot_Reader::throw_invalid();
+					optional.choices.push_back(choice);
+				}
+			}
+			optional.occurrences = occurrences;
+		}
+		const std::size_t extra_count = reader.read_u32();
+		for (std::size_t i = 0; i < extra_count; ++i)
+			state.extra_args.push_back(reader.read_string().data());
+		if (!reader.at_end())
+			Snapshot_Reader::throw_invalid();
+	}
+
+	CPPARSE_INLINE void Argument_Parser::complete_request(int argc, const char *const *argv) {
+		const auto line = std::getenv("COMP_LINE");
+		if (!line) {
+			print_completions(argc, argv);
+			return;
+		}
+		String_View text{line};
+		const auto point = std::getenv("COMP_POINT");
+		if (point) {
+			const auto end = std::strtoul(point, nullptr, 10);
+			if (end < text.size())
+				text = String_View{text.data(), end};
+		}
+
+		std::vector<std::string> words;
+		bool in_word{false};
+		for (const auto c : text) {
+			if (c == ' ' || c == '\t') {
+				in_word = false;
+			} else {
+				if (!in_word)
+					words.emplace_back();
+				words.back().push_back(c);
+				in_word = true;
+			}
+		}
+		if (!in_word)
+			words.emplace_back();
+		std::vector<const char *> word_args;
+		for (std::size_t i = 1; i < words.size(); ++i)
+			word_args.push_back(words[i].c_str());
+		print_completions(static_cast<int>(word_args.size()), word_args.data());
+	}
+
+	CPPARSE_INLINE void Argument_Parser::run_batch(std::size_t count, std::size_t thread_count, const std::function<void(Parse_Result &, std::size_t, std::size_t)> &parse_lines) const {
+		const std::size_t chunks = (count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+		if (thread_count == 0)
+			thread_count = std::thread::hardware_concurrency();
+		if (thread_count > chunks)
+			thread_count = chunks;
+
+		std::atomic<std::size_t> next{0};
+		std::mutex failure_mutex;
+		std::exception_ptr failure;
+		const auto worker = [&]() {
+			CPPARSE_TRY {
+				Parse_Result scratch{m_result_resource};
+				for (;;) {
+					const std::size_t begin = next.fetch_add(BATCH_CHUNK, std::memory_order_relaxed);
+					if (begin >= count)
+						return;
+					parse_lines(scratch, begin, count - begin < BATCH_CHUNK ? count : begin + BATCH_CHUNK);
+				}
+			} CPPARSE_CATCH_ALL {
+				std::lock_guard<std::mutex> lock{failure_mutex};
+				if (!failure)
+					failure = std::current_exception();
+				next.store(count, std::memory_order_relaxed);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		if (thread_count > 1) {
+			threads.reserve(thread_count - 1);
+			CPPARSE_TRY {
+				while (threads.size() + 1 < thread_count)
+					threads.emplace_back(worker);
+			} CPPARSE_CATCH(const std::system_error &) {
+				/* Continue with the threads that could be started */
+			}
+		}
+		worker();
+		for (auto &thread : threads)
+			thread.join();
+		if (failure)
+			std::rethrow_exception(failure);
+	}
+
+	CPPARSE_INLINE Parse_Status Argument_Parser::dispatch_subcommand(Parse_State &state, int &argc, const char **&argv) {
+		auto &parser = subparser(state.subcommand);
+		std::string joined{to_string(state.script_name)};
+		joined += ' ';
+		joined.append(state.subcommand.data(), state.subcommand.size());
+		auto &args = state.subcommand_args;
+		args.push_back(state.pool.intern(joined).data());
+		args.insert(args.end(), state.extra_args.begin() + 1, state.extra_args.end());
+		auto sub_argc = static_cast<int>(args.size());
+		auto sub_argv = args.data();
+		const auto status = parser.try_parse_args(sub_argc, sub_argv);
+		if (status)
+			remove_matched(state, sub_argv + 1, sub_argv + sub_argc, argc, argv);
+		return status;
+	}
+
+}
+
+#endif /* CPARSEPARSE_ARGUMENT_PARSER_IMPL_H_ */
@@ -7,15 +7,44 @@
 #ifndef CPARSEPARSE_ARGUMENT_PARSER
 #define CPARSEPARSE_ARGUMENT_PARSER
 
+#include "cparseparse/argument-schema.h"
+#include "cparseparse/batch-result.h"
 #include "cparseparse/optional-info.h"
+#include "cparseparse/parse-observer.h"
+#include "cparseparse/parse-result.h"
 #include "cparseparse/positional-info.h"
 #include "cparseparse/util/compat.h"
-#include <regex>
-#include <unordered_map>
-#include <unordered_set>
+#include "cparseparse/util/lexer.h"
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/name-index.h"
+#include "cparseparse/util/string-view.h"
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace cpparse {
 
+#ifdef CPPARSE_COMPILED_LIB
+#ifdef CPPARSE_INSTRUMENTATION
+#define CPPARSE_LIB_CONFIG_CHECK _lib_config_instrumented
+#else
+#define CPPARSE_LIB_CONFIG_CHECK _lib_config_default
+#endif /* CPPARSE_INSTRUMENTATION */
+
+	/**
+	 * Defined only by a libcparseparse.a built with the same
+	 * CPPARSE_INSTRUMENTATION setting, so that a program whose parser layout
+	 * differs from the library's fails to link.
+	 */
+	void CPPARSE_LIB_CONFIG_CHECK() noexcept;
+#endif /* CPPARSE_COMPILED_LIB */
+
 	/**
 	 * Command-line argument parser.
 	 *
@@ -23,6 +52,9 @@ namespace cpparse {
 	 * 1. Add argument definitions using add_positional() and add_optional().
 	 * 2. Pass the user-supplied command-line arguments to parse_args().
 	 * 3. Retrieve each argument by name using arg() and arg_at().
+	 *
+	 * Once the arguments are defined, the const parse() functions may be called
+	 * concurrently from any number of threads, each filling its own Parse_Result.
 	 */
 	class Argument_Parser {
 	public:
@@ -33,13 +65,125 @@ namespace cpparse {
 		class Options {
 			friend class Argument_Parser;
 			bool m_auto_help{true};  // Automatically add a '-h/--help' flag
+			bool m_copy_args{true};  // Copy argument values out of argv
+			bool m_response_files{false};  // Expand '@path' arguments
+			bool m_completion{false};  // Answer shell completion requests
+			bool m_allow_abbrev{false};  // Accept unambiguous long option prefixes
+			std::size_t m_help_width{0};  // Width to wrap the help text to
+			Memory_Resource *m_schema_resource{nullptr};  // Storage for argument definitions
+			Memory_Resource *m_result_resource{nullptr};  // Storage for parsed values
+#ifdef CPPARSE_INSTRUMENTATION
+			Parse_Observer *m_observer{nullptr};  // Receiver of parse timings and counters
+#endif /* CPPARSE_INSTRUMENTATION */
 		public:
+
+			/** Value of help_width() that wraps the help text to the terminal width */
+			static constexpr std::size_t TERMINAL_WIDTH{static_cast<std::size_t>(-1)};
+
 			Options() noexcept { }
 
 			Options &auto_help(bool auto_help) noexcept {
 				m_auto_help = auto_help;
 				return *this;
 			}
+
+			/**
+			 * When disabled, parsed values are stored as views into the argv strings
+			 * passed to parse_args() instead of being copied. The argv strings must
+			 * then outlive any use of the parsed values.
+			 */
+			Options &copy_args(bool copy_args) noexcept {
+				m_copy_args = copy_args;
+				return *this;
+			}
+
+			/**
+			 * When enabled, each '@path' argument is replaced by the arguments read
+			 * from the file at @a path, following the gcc/clang response file rules.
+			 * Response files may refer to further response files. An '@path' argument
+			 * is kept as-is if the file cannot be read.
+			 *
+			 * Each file is memory-mapped read-only and tokenized without copying:
+			 * values read from it refer into the mapping, which is kept until the next
+			 * parse. Only arguments that contain quotes or escapes, or that are
+			 * returned as extra arguments, are copied into the result. A parse error in an argument read from a file reports the index of the
+			 * '@path' argument and the offset of the argument within the file.
+			 */
+			Options &response_files(bool response_files) noexcept {
+				m_response_files = response_files;
+				return *this;
+			}
+
+			/**
+			 * When enabled, parse_args() answers shell completion requests: if the first
+			 * argument is the hidden '--cpparse-complete' flag, the completions are
+			 * printed by print_completions() and std::exit(0) is called before any
+			 * other argument is examined. The words to complete are taken from the
+			 * bash @p COMP_LINE and @p COMP_POINT variables when set (as by
+			 * @p complete -C), or from the arguments following the flag otherwise.
+			 */
+			Options &completion(bool completion) noexcept {
+				m_completion = completion;
+				return *this;
+			}
+
+			/**
+			 * When enabled, a long option may be abbreviated to any prefix of its name
+			 * that no other optional argument name shares, as with getopt_long(); an
+			 * ambiguous prefix is an error. Configuration file keys must still be
+			 * given in full.
+			 */
+			Options &allow_abbrev(bool allow_abbrev) noexcept {
+				m_allow_abbrev = allow_abbrev;
+				return *this;
+			}
+
+			/**
+			 * Word-wrap the help text to the given number of columns, indenting the
+			 * continuation lines of each argument's help to the help column. With
+			 * TERMINAL_WIDTH, the width is that of the terminal when the help is
+			 * printed, or 80 columns when the output is not a terminal. The help text
+			 * is not wrapped when the width is 0, the default.
+			 */
+			Options &help_width(std::size_t width) noexcept {
+				m_help_width = width;
+				return *this;
+			}
+#ifdef CPPARSE_HAS_PMR
+
+			/**
+			 * Allocate the argument definition tables from the given memory resource.
+			 * The resource must outlive the parser.
+			 */
+			Options &schema_resource(Memory_Resource *resource) noexcept {
+				m_schema_resource = resource;
+				return *this;
+			}
+
+			/**
+			 * Allocate the state populated by parse_args(), including copied argument
+			 * values and the caches of values converted by arg() and args(), from the
+			 * given memory resource. The resource must outlive the parser.
+			 *
+			 * The converted values themselves are held in a std::vector, which
+			 * args_ref() returns, and so are allocated from the global heap.
+			 */
+			Options &result_resource(Memory_Resource *resource) noexcept {
+				m_result_resource = resource;
+				return *this;
+			}
+#endif /* CPPARSE_HAS_PMR */
+#ifdef CPPARSE_INSTRUMENTATION
+
+			/**
+			 * Report the timing of each parse phase and conversion, and the counters of
+			 * each parse, to the given observer. The observer must outlive the parser.
+			 */
+			Options &observer(Parse_Observer *observer) noexcept {
+				m_observer = observer;
+				return *this;
+			}
+#endif /* CPPARSE_INSTRUMENTATION */
 		};
 
 		/**
@@ -48,7 +192,23 @@ namespace cpparse {
 		 * @param opts  configuration options
 		 */
 		Argument_Parser(const Options &opts = Options{})
-				: m_auto_help{opts.m_auto_help} {
+				: m_auto_help{opts.m_auto_help},
+				  m_copy_args{opts.m_copy_args},
+				  m_response_files{opts.m_response_files},
+				  m_completion{opts.m_completion},
+				  m_allow_abbrev{opts.m_allow_abbrev},
+				  m_help_width{opts.m_help_width},
+				  m_result_resource{opts.m_result_resource},
+#ifdef CPPARSE_INSTRUMENTATION
+				  m_observer{opts.m_observer},
+#endif /* CPPARSE_INSTRUMENTATION */
+				  m_schema{make_resource_unique<Argument_Schema>(opts.m_schema_resource, opts.m_schema_resource)},
+				  m_result{opts.m_result_resource},
+				  m_help_cache{make_help_cache()} {
+#ifdef CPPARSE_COMPILED_LIB
+			CPPARSE_LIB_CONFIG_CHECK();
+#endif /* CPPARSE_COMPILED_LIB */
+			m_result.m_schema = m_schema.get();
 			if (m_auto_help) {
 				add_optional("-h", "--help", Optional_Info::Type::FLAG).help("display this help text");
 				set_help_handler([](const Argument_Parser &parser) {
@@ -78,6 +238,7 @@ namespace cpparse {
 		template<class String>
 		void set_description(String &&description) noexcept {
 			m_description = std::forward<String>(description);
+			++m_schema->revision;
 		}
 
 		/**
@@ -107,14 +268,22 @@ namespace cpparse {
 		 */
 		Positional_Info &add_positional(std::string name) {
 			if (!valid_positional_name(name))
-				throw std::logic_error{lerrstr("invalid positional argument name '", name, "'")};
-			if (m_optional_args.find(name) != m_optional_args.end())
-				throw std::logic_error{lerrstr("positional argument name conflicts with optional argument reference name '", name, "'")};
-			const auto pair = m_positional_args.emplace(name, make_unique<Positional_Info>(name));
-			if (!pair.second)
-				throw std::logic_error{lerrstr("duplicate positional argument name '", name, "'")};
-			m_positional_order.push_back(std::move(name));
-			return *pair.first->second;
+				CPPARSE_THROW(std::logic_error{lerrstr("invalid positional argument name '", name, "'")});
+			auto &schema = *m_schema;
+			const auto existing = schema.names.find(name);
+			if (existing != Name_Index::NPOS && !Argument_Schema::is_positional_ref(existing))
+				CPPARSE_THROW(std::logic_error{lerrstr("positional argument name conflicts with optional argument reference name '", name, "'")});
+			if (existing != Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("duplicate positional argument name '", name, "'")});
+			auto &state = m_result.state();
+			state.bind(schema.positionals.size() + 1, schema.optionals.size());
+			schema.positionals.emplace_back(std::move(name), state);
+			auto &positional = schema.positionals.back();
+			positional.set_index(schema.positionals.size() - 1);
+			positional.set_revision(schema.revision);
+			++schema.revision;
+			schema.names.insert(positional.name(), Argument_Schema::positional_ref(positional.m_index));
+			return positional;
 		}
 
 		/**
@@ -136,14 +305,24 @@ namespace cpparse {
 		Optional_Info &add_optional(std::string long_name, Optional_Info::Type type = Optional_Info::Type::SINGLE) {
 			auto formatted_name = format_option_name(long_name);
 			if (formatted_name.empty())
-				throw std::logic_error{lerrstr("invalid optional argument name: ", long_name)};
-			if (m_positional_args.find(formatted_name) != m_positional_args.end())
-				throw std::logic_error{lerrstr("optional argument reference name conflicts with positional argument name '", formatted_name, "'")};
-			const auto pair = m_optional_args.emplace(formatted_name, make_unique<Optional_Info>(formatted_name, type));
-			if (!pair.second)
-				throw std::logic_error{lerrstr("duplicate optional argument name '", formatted_name, "'")};
-			m_optional_order.push_back(std::move(formatted_name));
-			return *pair.first->second;
+				CPPARSE_THROW(std::logic_error{lerrstr("invalid optional argument name: ", long_name)});
+			auto &schema = *m_schema;
+			const auto existing = schema.names.find(formatted_name);
+			if (existing != Name_Index::NPOS && Argument_Schema::is_positional_ref(existing))
+				CPPARSE_THROW(std::logic_error{lerrstr("optional argument reference name conflicts with positional argument name '", formatted_name, "'")});
+			if (existing != Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("duplicate optional argument name '", formatted_name, "'")});
+			auto &state = m_result.state();
+			state.bind(schema.positionals.size(), schema.optionals.size() + 1);
+			schema.optionals.emplace_back(std::move(formatted_name), type, state);
+			auto &optional = schema.optionals.back();
+			optional.set_index(schema.optionals.size() - 1);
+			optional.set_env_index(schema.env_names);
+			optional.set_revision(schema.revision);
+			++schema.revision;
+			schema.names.insert(optional.name(), static_cast<std::uint32_t>(optional.m_index));
+			schema.long_names.insert(optional.name(), static_cast<std::uint32_t>(optional.m_index));
+			return optional;
 		}
 
 		/**
@@ -168,15 +347,76 @@ namespace cpparse {
 		Optional_Info &add_optional(std::string flag, String &&long_name, Optional_Info::Type type = Optional_Info::Type::SINGLE) {
 			const auto formatted_name = format_flag_name(flag);
 			if (!formatted_name)
-				throw std::logic_error{lerrstr("invalid flag name '", flag, "'")};
-			if (m_flags.find(formatted_name) != m_flags.end())
-				throw std::logic_error{lerrstr("duplicate flag name '", flag, "'")};
+				CPPARSE_THROW(std::logic_error{lerrstr("invalid flag name '", flag, "'")});
+			if (m_schema->flags[formatted_name] != Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("duplicate flag name '", flag, "'")});
 			auto &optional = add_optional(std::forward<String>(long_name), std::move(type));
 			optional.set_flag(formatted_name);
-			m_flags.emplace(optional.flag(), optional.name()).first;
+			m_schema->flags[formatted_name] = static_cast<std::uint32_t>(optional.m_index);
+			++m_schema->revision;
 			return optional;
 		}
 
+		/**
+		 * Define a subcommand with the given name.
+		 *
+		 * The first positional argument after the parser's own positional arguments
+		 * selects a subcommand, and the arguments following it are parsed by the
+		 * subcommand's parser. The subcommand parser is only constructed, and
+		 * @a factory only invoked to define its arguments, when the subcommand is
+		 * first selected or retrieved with subparser(), so defining many subcommands
+		 * costs little at startup.
+		 *
+		 * @tparam Factory  callable type taking an @a Argument_Parser reference
+		 * @param name      subcommand name, in the same format as positional names
+		 * @param factory   callable that defines the subcommand's arguments
+		 * @param help      help text listed under "Commands:" in the help text
+		 * @param opts      configuration options for the subcommand parser
+		 * @throw std::logic_error  If @a name is not in the correct format or is a
+		 *                          duplicate.
+		 */
+		template<class Factory>
+		void add_subcommand(std::string name, Factory &&factory, std::string help = {}, const Options &opts = Options{}) {
+			if (!valid_positional_name(name))
+				CPPARSE_THROW(std::logic_error{lerrstr("invalid subcommand name '", name, "'")});
+			if (m_subcommand_names.find(name) != Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("duplicate subcommand name '", name, "'")});
+			m_subcommands.emplace_back(std::move(name), std::move(help), std::forward<Factory>(factory), opts);
+			m_subcommand_names.insert(m_subcommands.back().name, static_cast<std::uint32_t>(m_subcommands.size() - 1));
+			++m_schema->revision;
+		}
+
+		/**
+		 * Retrieve the parser of the named subcommand, constructing it if necessary.
+		 *
+		 * After parse_args() has selected a subcommand, its parser holds the values of
+		 * the subcommand's arguments.
+		 *
+		 * @param name  subcommand name
+		 * @return the subcommand parser
+		 * @throw std::logic_error  If no subcommand with the specified name exists.
+		 */
+		Argument_Parser &subparser(String_View name) {
+			const auto idx = m_subcommand_names.find(name);
+			if (idx == Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("no subcommand named '", name, "'")});
+			auto &subcommand = m_subcommands[idx];
+			if (!subcommand.parser) {
+				std::unique_ptr<Argument_Parser> parser{new Argument_Parser{subcommand.opts}};
+				subcommand.factory(*parser);
+				subcommand.parser = std::move(parser);
+			}
+			return *subcommand.parser;
+		}
+
+		/**
+		 * @return the name of the subcommand selected by parse_args(), or an empty
+		 *         string if none was selected.
+		 */
+		String_View subcommand() const noexcept {
+			return m_result.subcommand();
+		}
+
 		/**
 		 * Parse the user-provided command-line arguments and match the values to the
 		 * program arguments.
@@ -185,6 +425,10 @@ namespace cpparse {
 		 * the values. After the call, @a argc and @a argv are updated to refer to any
 		 * remaining command-line arguments not matched by the registered arguments.
 		 *
+		 * If a subcommand is selected, the arguments following it are passed to
+		 * parse_args() of the subcommand's parser, and @a argc and @a argv refer to
+		 * the arguments that it did not match.
+		 *
 		 * @param argc  reference to command-line argument count
 		 * @param argv  reference to command-line argument strings
 		 * @throw std::runtime_error  If a positional argument is missing, a value for
@@ -200,8 +444,250 @@ namespace cpparse {
 		 * @see parse_args()
 		 */
 		void parse_args(int &argc, const char **&argv) {
-			errstr_set_script_name(argv[0]);
-			remove_matched(assign_user_args(argc, argv), argc, argv);
+			const auto status = try_parse_args(argc, argv);
+			if (!status)
+				CPPARSE_THROW(std::runtime_error{status.message()});
+		}
+
+		/**
+		 * Parse the command-line arguments as by parse_args(), reporting a parse error
+		 * through the returned status rather than throwing it.
+		 *
+		 * On error, the parsed values are cleared and @a argc and @a argv are
+		 * unchanged. Errors in the argument definitions still throw (or abort, when
+		 * exceptions are disabled).
+		 *
+		 * @param argc  reference to command-line argument count
+		 * @param argv  reference to command-line argument strings
+		 * @return the parse status
+		 */
+		Parse_Status try_parse_args(int &argc, char **&argv) {
+			return try_parse_args(argc, const_cast<const char **&>(argv));
+		}
+
+		/**
+		 * @see try_parse_args()
+		 */
+		Parse_Status try_parse_args(int &argc, const char **&argv);
+
+		/**
+		 * Parse the command-line arguments into a new result.
+		 *
+		 * Unlike parse_args(), this function does not modify the parser, and may be
+		 * called concurrently with other parse() calls. The help handler is not
+		 * invoked; use Parse_Result::help_requested() instead. Unmatched positional
+		 * arguments are available from Parse_Result::extra_args().
+		 *
+		 * Subcommands are not parsed; Parse_Result::subcommand() names the selected
+		 * subcommand, and the extra arguments start with its name followed by its
+		 * arguments, ready to be passed to parse() of subparser().
+		 *
+		 * @param argc  command-line argument count
+		 * @param argv  command-line argument strings
+		 * @return the parse result, which must not outlive the parser
+		 * @throw std::runtime_error  If the arguments do not match the argument
+		 *                            definitions, as for parse_args().
+		 */
+		Parse_Result parse(int argc, const char *const *argv) const {
+			Parse_Result result{m_result_resource};
+			parse(argc, argv, result);
+			return result;
+		}
+
+		/**
+		 * Parse the command-line arguments into an existing result, reusing its
+		 * storage.
+		 *
+		 * @see parse()
+		 *
+		 * @param argc    command-line argument count
+		 * @param argv    command-line argument strings
+		 * @param result  result to fill; cleared on error
+		 */
+		void parse(int argc, const char *const *argv, Parse_Result &result) const {
+			const auto status = try_parse(argc, argv, result);
+			if (!status)
+				CPPARSE_THROW(std::runtime_error{status.message()});
+		}
+
+		/**
+		 * Parse the command-line arguments into an existing result as by parse(),
+		 * reporting a parse error through the returned status rather than throwing
+		 * it.
+		 *
+		 * @param argc    command-line argument count
+		 * @param argv    command-line argument strings
+		 * @param result  result to fill; its values are cleared on error
+		 * @return the parse status
+		 */
+		Parse_Status try_parse(int argc, const char *const *argv, Parse_Result &result) const;
+
+		/**
+		 * Parse a batch of command lines concurrently.
+		 *
+		 * Each line is parsed as by parse(). The lines are handed out to the threads
+		 * in small chunks on demand, so that uneven line lengths do not leave threads
+		 * idle. Parse errors are recorded in the line's Batch_Result rather than
+		 * thrown, and their messages formatted only when requested. When a result
+		 * resource is set, it must be safe to use from multiple threads.
+		 *
+		 * @tparam Range        random-access range of command lines, each providing
+		 *                      size() and data() for its argv strings (for example,
+		 *                      @a std::vector<const char *>)
+		 * @param lines         command lines to parse; must outlive the results if
+		 *                      copy_args() is disabled, and the error() calls of
+		 *                      failed results
+		 * @param thread_count  number of threads to use, or 0 to use
+		 *                      @a std::thread::hardware_concurrency()
+		 * @return the result of each line, in order
+		 */
+		template<class Range>
+		std::vector<Batch_Result> parse_batch(const Range &lines, std::size_t thread_count = 0) const {
+			const auto first = std::begin(lines);
+			const auto count = static_cast<std::size_t>(std::end(lines) - first);
+			std::vector<Batch_Result> results(count);
+			run_batch(count, thread_count, [this, &first, &results](Parse_Result &scratch, std::size_t begin, std::size_t end) {
+				for (auto i = begin; i < end; ++i)
+					parse_batch_line(first[i], scratch, results[i]);
+			});
+			return results;
+		}
+
+		/**
+		 * Read optional argument values from a configuration file.
+		 *
+		 * Call after parse_args(), which discards any previously read values. Each
+		 * line of the file is one of:
+		 * - @p key=value, where @a key is an optional argument reference name. The
+		 *   value is trimmed, and may be enclosed in single or double quotes.
+		 * - @p key alone, which sets a flag argument.
+		 * - @p [section], which prefixes the keys that follow with @p section- (an
+		 *   empty section name removes the prefix).
+		 * - A blank line, or a comment starting with @p '#' or @p ';'.
+		 *
+		 * Values already supplied on the command line (or by an earlier file) take
+		 * precedence; such keys are skipped without examining their values. Within a
+		 * file, append-type arguments accumulate values and other arguments may be
+		 * given once, as on the command line.
+		 *
+		 * The file is read one line at a time, so memory use is bounded by the
+		 * longest line plus the stored values.
+		 *
+		 * @param path  configuration file path
+		 * @throw std::runtime_error  If the file cannot be read, or a line is
+		 *                            malformed or does not match the argument
+		 *                            definitions. The values read by parse_args() are
+		 *                            discarded on a matching error.
+		 */
+		void parse_config_file(const std::string &path);
+
+		/**
+		 * Read optional argument values from a configuration stream.
+		 *
+		 * @see parse_config_file()
+		 *
+		 * @param in      configuration stream
+		 * @param source  name of the stream used in error messages
+		 */
+		void parse_config(std::istream &in, String_View source = "config") {
+			auto &state = m_result.state();
+			CPPARSE_TRY {
+				match_config(in, source, state);
+			} CPPARSE_CATCH_ALL {
+				state.clear();
+				CPPARSE_RETHROW;
+			}
+		}
+
+		/**
+		 * Read optional argument values from a configuration stream into a result
+		 * filled by parse().
+		 *
+		 * @see parse_config_file()
+		 *
+		 * @param in      configuration stream
+		 * @param result  result to add the values to; cleared on error
+		 * @param source  name of the stream used in error messages
+		 */
+		void parse_config(std::istream &in, Parse_Result &result, String_View source = "config") const {
+			auto &state = result.state();
+			result.m_schema = m_schema.get();
+			CPPARSE_TRY {
+				state.bind(m_schema->positionals.size(), m_schema->optionals.size());
+				match_config(in, source, state);
+			} CPPARSE_CATCH_ALL {
+				state.clear();
+				CPPARSE_RETHROW;
+			}
+		}
+
+		/**
+		 * Serialize the values matched by parse_args() into a compact binary
+		 * snapshot.
+		 *
+		 * @see Parse_Result::snapshot()
+		 */
+		std::vector<char> snapshot() const {
+			return m_result.snapshot();
+		}
+
+		/**
+		 * Load the values of a snapshot taken by a parser with the same argument
+		 * definitions, in place of parse_args().
+		 *
+		 * The values are not copied or re-lexed: the parser refers to the strings in
+		 * the snapshot buffer, which must stay valid (for example, a shared memory
+		 * mapping) until the next parse or reset(). The help handler is not invoked
+		 * and no values are reported to on_value() callbacks.
+		 *
+		 * @param data  snapshot bytes
+		 * @param size  snapshot size in bytes
+		 * @throw std::runtime_error  If the snapshot is truncated, malformed, or of an
+		 *                            unsupported version.
+		 * @throw std::logic_error    If the snapshot was taken with different
+		 *                            argument definitions.
+		 */
+		void load_snapshot(const void *data, std::size_t size) {
+			auto &state = m_result.state();
+			CPPARSE_TRY {
+				read_snapshot(static_cast<const char *>(data), size, state);
+				m_script_name = to_string(state.script_name);
+			} CPPARSE_CATCH_ALL {
+				state.clear();
+				CPPARSE_RETHROW;
+			}
+		}
+
+		/**
+		 * Load the values of a snapshot into a result.
+		 *
+		 * @see load_snapshot()
+		 *
+		 * @param data    snapshot bytes
+		 * @param size    snapshot size in bytes
+		 * @param result  result to fill; cleared on error
+		 */
+		void load_snapshot(const void *data, std::size_t size, Parse_Result &result) const {
+			auto &state = result.state();
+			result.m_schema = m_schema.get();
+			CPPARSE_TRY {
+				read_snapshot(static_cast<const char *>(data), size, state);
+			} CPPARSE_CATCH_ALL {
+				state.clear();
+				CPPARSE_RETHROW;
+			}
+		}
+
+		/**
+		 * Discard the values matched by parse_args(), keeping the argument
+		 * definitions.
+		 *
+		 * The storage used for the values is retained, so that repeatedly parsing
+		 * similar command lines with the same parser does not allocate once the
+		 * buffers have grown to size. parse_args() resets the parser implicitly.
+		 */
+		void reset() noexcept {
+			m_result.state().clear();
 		}
 
 		/**
@@ -214,8 +700,8 @@ namespace cpparse {
 		 * @throw std::logic_error  If no optional argument with the specified name
 		 *                          exists.
 		 */
-		bool has_arg(const std::string &name) const {
-			return lookup_optional(name).exists();
+		bool has_arg(String_View name) const {
+			return m_result.has_arg(name);
 		}
 
 		/**
@@ -235,8 +721,8 @@ namespace cpparse {
 		 * @throw std::runtime_error  If the argument cannot be parsed as type @a T.
 		 */
 		template<class T>
-		T arg(const std::string &name) const {
-			return arg_at<T>(name, 0);
+		T arg(String_View name) const {
+			return m_result.arg<T>(name);
 		}
 
 		/**
@@ -258,8 +744,8 @@ namespace cpparse {
 		 * @throw std::runtime_error  If the argument cannot be parsed as type @a T.
 		 */
 		template<class T>
-		T arg(const std::string &name, T &&default_val) const {
-			return arg_at<T>(name, 0, std::forward<T>(default_val));
+		T arg(String_View name, T &&default_val) const {
+			return m_result.arg<T>(name, std::forward<T>(default_val));
 		}
 
 		/**
@@ -279,14 +765,29 @@ namespace cpparse {
 		 * @throw std::runtime_error  If the argument cannot be parsed as type @a T.
 		 */
 		template<class T>
-		std::vector<T> args(const std::string &name) const {
-			const auto count = arg_count(name);
+		std::vector<T> args(String_View name) const {
+			return m_result.args<T>(name);
+		}
 
-			std::vector<T> values;
-			values.reserve(count);
-			for (std::size_t i = 0; i < count; ++i)
-				values.push_back(arg_at<T>(name, i));
-			return values;
+		/**
+		 * Retrieve a reference to the list of values that the user supplied for the
+		 * given argument.
+		 *
+		 * Behaves like args(), but the parsed values are cached on first use and the
+		 * same vector is returned on later calls with the same type @a T. The
+		 * reference is valid until parse_args() is called again.
+		 *
+		 * @tparam T    type to parse arguments as.
+		 * @param name  optional argument reference name.
+		 * @return A reference to a vector containing the user-supplied values parsed
+		 *         as type @a T.
+		 * @throw std::logic_error    If no optional argument with the specified name
+		 *                            exists.
+		 * @throw std::runtime_error  If the argument cannot be parsed as type @a T.
+		 */
+		template<class T>
+		const std::vector<T> &args_ref(String_View name) const {
+			return m_result.args_ref<T>(name);
 		}
 
 		/**
@@ -309,8 +810,8 @@ namespace cpparse {
 		 * @throw std::runtime_error  If the argument cannot be parsed as type @a T.
 		 */
 		template<class T>
-		T arg_at(const std::string &name, std::size_t idx) const {
-			return arg_at<T, false>(name, idx, T{});
+		T arg_at(String_View name, std::size_t idx) const {
+			return m_result.arg_at<T>(name, idx);
 		}
 
 		/**
@@ -335,323 +836,727 @@ namespace cpparse {
 		 * @throw std::runtime_error  If the argument cannot be parsed as type @a T.
 		 */
 		template<class T>
-		T arg_at(const std::string &name, std::size_t idx, T &&default_val) const {
-			return arg_at<T, true>(name, idx, std::forward<T>(default_val));
+		T arg_at(String_View name, std::size_t idx, T &&default_val) const {
+			return m_result.arg_at<T>(name, idx, std::forward<T>(default_val));
+		}
+
+		/**
+		 * Retrieve the value of the argument as by arg(), reporting a conversion
+		 * error through the returned status rather than throwing it.
+		 *
+		 * @tparam T    type to parse argument as.
+		 * @param name  positional or optional argument name.
+		 * @param out   set to the parsed value; left unchanged if the user did not
+		 *              supply a value or it cannot be parsed
+		 * @return the status of the conversion
+		 * @throw std::logic_error  If no positional or optional argument with the
+		 *                          specified name exists.
+		 */
+		template<class T>
+		Parse_Status try_arg(String_View name, T &out) const {
+			return m_result.try_arg<T>(name, out);
+		}
+
+		/**
+		 * Retrieve the value of the argument at the specified index as by arg_at(),
+		 * reporting a conversion error through the returned status rather than
+		 * throwing it.
+		 *
+		 * @tparam T    type to parse argument as.
+		 * @param name  positional or optional argument name.
+		 * @param idx   index at which to retrieve argument.
+		 * @param out   set to the parsed value; left unchanged if the user did not
+		 *              supply a value at the index or it cannot be parsed
+		 * @return the status of the conversion
+		 * @throw std::logic_error  If no positional or optional argument with the
+		 *                          specified name exists.
+		 */
+		template<class T>
+		Parse_Status try_arg_at(String_View name, std::size_t idx, T &out) const {
+			return m_result.try_arg_at<T>(name, idx, out);
 		}
 
 		/**
 		 * Get the number of values provided for the specified optional append-type
-		 * argument.
+		 * argument, or the number of times the specified flag argument was given.
 		 *
-		 * @param name  optional append-type argument reference name.
+		 * @param name  optional argument reference name.
 		 * @return The number of provided values.
 		 * @throw std::logic_error  If no optional argument with the specified name
 		 *                          exists.
 		 */
-		std::size_t arg_count(const std::string &name) const {
-			return lookup_optional(name).count();
+		std::size_t arg_count(String_View name) const {
+			return m_result.arg_count(name);
 		}
 
 		/**
-		 * Print usage text to stdout.
+		 * Retrieve the position of the specified optional argument's value in its
+		 * choices() list.
+		 *
+		 * The position is recorded when the value is matched, so no strings are
+		 * compared.
 		 *
-		 * @param out  output stream [default: @a std::cout]
+		 * @param name  optional argument reference name.
+		 * @return The index of the value among the choices.
+		 * @throw std::logic_error   If no optional argument with the specified name
+		 *                           exists, or the argument has no choices.
+		 * @throw std::out_of_range  If no value was given for the argument.
 		 */
-		void print_usage(std::ostream &out = std::cout) const {
-			out << "Usage: " << _scriptname;
-			if (!m_optional_args.empty())
-				out << " [options]";
-			for (const auto &positional : m_positional_order)
-				out << " <" << positional << ">";
-			out << std::endl;
+		std::size_t choice(String_View name) const {
+			return m_result.choice(name);
 		}
 
 		/**
-		 * Print help text to stdout.
+		 * Retrieve the position of the specified optional argument's value in its
+		 * choices() list, or the given default if no value was given.
 		 *
-		 * @param out  output stream [default: @a std::cout]
+		 * @param name            optional argument reference name.
+		 * @param default_choice  index to return if no value was given.
+		 * @return The index of the value among the choices.
+		 * @throw std::logic_error  If no optional argument with the specified name
+		 *                          exists, or the argument has no choices.
 		 */
-		void print_help(std::ostream &out = std::cout) const {
-			print_usage(out);
-			if (!m_description.empty())
-				out << std::endl << "  " << m_description << std::endl;
-			if (!m_positional_order.empty()) {
-				out << std::endl << "Positional arguments:" << std::endl;
-				for (const auto &positional : m_positional_order)
-					m_positional_args.at(positional)->print(20, out);
-			}
-			if (!m_optional_args.empty()) {
-				out << std::endl << "Options:" << std::endl;
-				for (const auto &optional : m_optional_order)
-					m_optional_args.at(optional)->print(30, out);
-			}
+		std::size_t choice(String_View name, std::size_t default_choice) const {
+			return m_result.choice(name, default_choice);
 		}
 
-	private:
+		/**
+		 * Retrieve the position of the specified optional append-type argument's
+		 * value at the given index in its choices() list.
+		 *
+		 * @param name  optional append-type argument reference name.
+		 * @param idx   index at which to retrieve value.
+		 * @return The index of the value among the choices.
+		 * @throw std::logic_error   If no optional argument with the specified name
+		 *                           exists, or the argument has no choices.
+		 * @throw std::out_of_range  If the index is out-of-range for the argument.
+		 */
+		std::size_t choice_at(String_View name, std::size_t idx) const {
+			return m_result.choice_at(name, idx);
+		}
 
 		/**
-		 * Determine if the character is a valid start for an option name.
+		 * @see has_arg()
+		 *
+		 * @param handle  optional argument handle.
+		 * @throw std::logic_error  If @a handle does not refer to an optional argument.
 		 */
-		static bool valid_option_char(char c) noexcept {
-			return !('0' <= c && c <= '9') && c != '-';
+		template<class T>
+		bool has_arg(const Arg_Handle<T> &handle) const {
+			return m_result.has_arg(handle);
 		}
 
 		/**
-		 * Check whether the positional argument name is valid.
+		 * @see arg()
+		 *
+		 * @param handle  positional or optional argument handle.
 		 */
-		static bool valid_positional_name(const std::string &name) {
-			std::cmatch m;
-			std::regex_match(name.c_str(), m, std::regex("\\w[a-zA-Z0-9_-]*"));
-			return !m.empty();
+		template<class T>
+		T arg(const Arg_Handle<T> &handle) const {
+			return m_result.arg(handle);
 		}
 
 		/**
-		 * Check whether the optional argument name is valid.
+		 * @see arg()
+		 *
+		 * @param handle       positional or optional argument handle.
+		 * @param default_val  value used when the user does not provide a value for the
+		 *                     argument.
+		 */
+		template<class T>
+		T arg(const Arg_Handle<T> &handle, const typename Arg_Handle<T>::Value &default_val) const {
+			return m_result.arg(handle, default_val);
+		}
+
+		/**
+		 * @see args()
+		 *
+		 * @param handle  optional argument handle.
+		 * @throw std::logic_error  If @a handle does not refer to an optional argument.
+		 */
+		template<class T>
+		std::vector<T> args(const Arg_Handle<T> &handle) const {
+			return m_result.args(handle);
+		}
+
+		/**
+		 * @see args_ref()
+		 *
+		 * @param handle  optional argument handle.
+		 * @throw std::logic_error  If @a handle does not refer to an optional argument.
+		 */
+		template<class T>
+		const std::vector<T> &args_ref(const Arg_Handle<T> &handle) const {
+			return m_result.args_ref(handle);
+		}
+
+		/**
+		 * @see arg_at()
+		 *
+		 * @param handle  positional or optional argument handle.
+		 * @param idx     index at which to retrieve argument.
+		 */
+		template<class T>
+		T arg_at(const Arg_Handle<T> &handle, std::size_t idx) const {
+			return m_result.arg_at(handle, idx);
+		}
+
+		/**
+		 * @see arg_at()
+		 *
+		 * @param handle       positional or optional argument handle.
+		 * @param idx          index at which to retrieve argument.
+		 * @param default_val  value used when the user does not provide a value for the
+		 *                     argument.
+		 */
+		template<class T>
+		T arg_at(const Arg_Handle<T> &handle, std::size_t idx, const typename Arg_Handle<T>::Value &default_val) const {
+			return m_result.arg_at(handle, idx, default_val);
+		}
+
+		/**
+		 * @see arg_count()
+		 *
+		 * @param handle  optional argument handle.
+		 * @throw std::logic_error  If @a handle does not refer to an optional argument.
+		 */
+		template<class T>
+		std::size_t arg_count(const Arg_Handle<T> &handle) const {
+			return m_result.arg_count(handle);
+		}
+
+		/**
+		 * Print the completions of the last of the given command-line words to
+		 * stdout, one per line.
+		 *
+		 * The earlier words are scanned to skip option values and to find the
+		 * selected subcommand, whose parser completes the words that follow it. A
+		 * word starting with @p '-' completes to the matching options; otherwise,
+		 * the matching subcommand names are printed when a subcommand may be given
+		 * at that position. The value of an option with choices() completes to the
+		 * matching choices. Nothing is printed for other option values and
+		 * positional arguments, leaving them to the shell's default completion.
+		 *
+		 * Only the argument definitions are consulted; the help text is not
+		 * formatted.
+		 *
+		 * @param argc  number of words, excluding the script name
+		 * @param argv  words, the last of which is the (possibly empty) prefix to
+		 *              complete
+		 */
+		void print_completions(int argc, const char *const *argv);
+
+		/**
+		 * Print the completions of the last of the given command-line words.
+		 *
+		 * @see print_completions()
+		 *
+		 * @param out  output stream
+		 */
+		void print_completions(int argc, const char *const *argv, std::ostream &out);
+
+		/**
+		 * Print usage text to stdout.
+		 */
+		void print_usage() const;
+
+		/**
+		 * Print usage text.
+		 *
+		 * @param out  output stream
+		 */
+		void print_usage(std::ostream &out) const;
+
+		/**
+		 * Print help text to stdout.
+		 */
+		void print_help() const;
+
+		/**
+		 * Print help text.
+		 *
+		 * The text is rendered once into a buffer kept by the parser and written with
+		 * a single write; it is rendered again only after a definition shown in it or
+		 * the program name changes, or when wrapping to a terminal whose width
+		 * changed. The arguments, subcommands and options share one help column,
+		 * placed after the longest name (up to a maximum); the help of an argument
+		 * with a longer name starts on the next line. print_help() may be called
+		 * from multiple threads, but not while arguments are being defined.
+		 *
+		 * @param out  output stream
+		 */
+		void print_help(std::ostream &out) const;
+
+	private:
+
+		/** Largest column that the help column is moved out to for long names */
+		static constexpr std::size_t MAX_HELP_COLUMN{30};
+
+		/**
+		 * Check whether the positional argument name is valid.
 		 */
-		static bool valid_option_name(const std::string &name) {
-			std::cmatch m;
-			std::regex_match(name.c_str(), m, std::regex("-([a-zA-Z_]|-?[a-zA-Z_][a-zA-Z0-9_-]+)"));
-			return !m.empty();
+		static bool valid_positional_name(const std::string &name) noexcept {
+			return lex_positional_name(name.c_str());
 		}
 
 		/**
 		 * Format the option name by removing the any leading '-' characters.
 		 */
 		static std::string format_option_name(const std::string &name) {
-			std::cmatch m;
-			std::regex_match(name.c_str(), m, std::regex("--?([a-zA-Z_][a-zA-Z0-9_-]+)"));
-			return m.size() < 2 ? "" : m[1].str();
+			const auto token = lex_token(name.c_str());
+			return token.kind == Token_Kind::OPTION ? std::string(token.name, token.length) : std::string{};
 		}
 
 		/**
 		 * Format the flag name by removing the leading '-' character.
 		 */
-		static char format_flag_name(const std::string &name) {
-			std::cmatch m;
-			std::regex_match(name.c_str(), m, std::regex("-([a-zA-Z_])"));
-			return m.size() < 2 ? 0 : m[1].str()[0];
+		static char format_flag_name(const std::string &name) noexcept {
+			const auto token = lex_token(name.c_str());
+			return token.kind == Token_Kind::FLAG ? token.name[0] : 0;
 		}
 
+		/** Number of command lines taken by a parse_batch() thread at a time */
+		static constexpr std::size_t BATCH_CHUNK{64};
+
+		/** Maximum nesting depth of response files */
+		static constexpr unsigned MAX_RESPONSE_FILE_DEPTH{16};
+
 		/**
-		 * Parsed argument token structure.
+		 * Subcommand definition, with its parser once constructed.
 		 */
-		struct Opt_Token {
-			enum class Type { OPT_NAME, OPT_VAL, FLAG };
-			Type type;
-			std::string value;
+		struct Subcommand {
+			template<class Factory>
+			Subcommand(std::string &&name, std::string &&help, Factory &&factory, const Options &opts)
+					: name{std::move(name)},
+					  help{std::move(help)},
+					  factory{std::forward<Factory>(factory)},
+					  opts{opts} { }
+
+			std::string name;
+			std::string help;
+			std::function<void(Argument_Parser &)> factory;
+			Options opts;
+			std::unique_ptr<Argument_Parser> parser;
 		};
 
-		/** Map structure to store matched optional arguments */
-		using Matched_Opts = std::unordered_map<std::string, std::vector<std::string>>;
+		/** Help text last rendered by print_help(); defined with the out-of-line functions */
+		struct Help_Cache;
+		using Help_Cache_Ptr = std::unique_ptr<Help_Cache, void (*)(Help_Cache *)>;
 
 		bool m_auto_help;
+		bool m_copy_args;
+		bool m_response_files;
+		bool m_completion;
+		bool m_allow_abbrev;
+		std::size_t m_help_width;
+		Memory_Resource *m_result_resource;
+#ifdef CPPARSE_INSTRUMENTATION
+		Parse_Observer *m_observer;
+#endif /* CPPARSE_INSTRUMENTATION */
+		std::string m_script_name;
 		std::function<void(const Argument_Parser &)> m_help_handler;
 		std::string m_description;
-		std::vector<std::string> m_positional_order;
-		std::unordered_map<std::string, std::unique_ptr<Positional_Info>> m_positional_args;
-		std::vector<std::string> m_optional_order;
-		std::unordered_map<std::string, std::unique_ptr<Optional_Info>> m_optional_args;
-		std::unordered_map<char, std::string> m_flags;
+		Resource_Ptr<Argument_Schema> m_schema;
+		Parse_Result m_result;
+		std::deque<Subcommand> m_subcommands;
+		Name_Index m_subcommand_names;
+		Help_Cache_Ptr m_help_cache;
+
+		/**
+		 * @return a new, empty help text cache
+		 */
+		static Help_Cache_Ptr make_help_cache();
+
+		/**
+		 * Append the usage line.
+		 *
+		 * @param out  string to append to
+		 */
+		void append_usage(std::string &out) const;
+
+		/**
+		 * Append the help text, word-wrapped to the given width.
+		 *
+		 * @param width  line width, or 0 to not wrap the text
+		 * @param out    string to append to
+		 */
+		void append_help(std::size_t width, std::string &out) const;
+
+		/**
+		 * Match the command-line arguments to their corresponding parameters in a
+		 * single pass.
+		 *
+		 * Each argument is lexed once; option values are written directly to the
+		 * matched Optional_State, positional values are collected for
+		 * assign_matched_pos() and extra arguments are collected as null-terminated
+		 * strings.
+		 *
+		 * @param invoke_help  whether to invoke the help handler, rather than only
+		 *                     recording the request in @a state
+		 * @return the parse status
+		 */
+		Parse_Status match_args(int argc, const char *const *argv, Parse_State &state, bool invoke_help) const;
 
 		/**
-		 * Parse the command-line arguments into tokens and match/assign them to their
-		 * corresponding parameters.
+		 * Match the command-line arguments, either null-terminated strings or
+		 * String_View arguments expanded from response files, in a single pass.
+		 *
+		 * @see match_args()
 		 */
-		std::vector<const char *> assign_user_args(int argc, const char **argv) {
-			std::vector<const char *> pos_args;
-			Matched_Opts opt_args;
-			std::tie(pos_args, opt_args) = match_args(argc, argv);
-			assign_matched_opt(std::move(opt_args));
-			return assign_matched_pos(std::move(pos_args));
+		template<class Arg>
+		Parse_Status match_tokens(Parse_State &state, int argc, const Arg *args, bool invoke_help) const;
+
+		/**
+		 * @return the characters of the argument
+		 */
+		static const char *arg_data(const char *arg) noexcept {
+			return arg;
+		}
+
+		static const char *arg_data(String_View arg) noexcept {
+			return arg.data();
 		}
 
 		/**
-		 * Assign the matched positional arguments to their corresponding parameters.
+		 * @return the argument as a null-terminated string, to be returned as an
+		 *         extra argument
 		 */
-		std::vector<const char *> assign_matched_pos(const std::vector<const char *> &pos_args) {
-			for (std::size_t i = 0; i < m_positional_order.size(); ++i)
-				m_positional_args[m_positional_order[i]]->set_value(pos_args[i]);
-			return std::vector<const char *>(pos_args.data() + m_positional_order.size(), pos_args.data() + pos_args.size());
+		static const char *arg_c_str(Parse_State &, const char *const *args, int arg_index) noexcept {
+			return args[arg_index];
+		}
+
+		static const char *arg_c_str(Parse_State &state, const String_View *, int arg_index) {
+			return state.arg_c_str(arg_index);
 		}
 
 		/**
-		 * Assign the matched optional arguments to their corresponding parameters.
+		 * @return a failed status for the parse
 		 */
-		void assign_matched_opt(Matched_Opts &&optional_args) {
-			for (auto &&pair : std::move(optional_args))
-				m_optional_args[pair.first]->set_values(std::move(pair.second));
+		static Parse_Status parse_error(const Parse_State &state, Parse_Errc code, int arg_index) noexcept {
+			if (arg_index < 0 || static_cast<std::size_t>(arg_index) >= state.arg_origins.size())
+				return Parse_Status{code, state.invoked_name, arg_index};
+			/* Report the position in the caller's arguments of an expanded argument */
+			const auto &origin = state.arg_origins[arg_index];
+			return Parse_Status{code, state.invoked_name, origin.arg_index}.with_file_offset(origin.offset);
 		}
 
 		/**
-		 * Parse the command-line arguments into tokens and match them to their
-		 * corresponding parameters.
+		 * Fill the optional arguments not given on the command line from the
+		 * environment variables that they read, in one pass over the environment.
+		 */
+		Parse_Status match_env(Parse_State &state) const;
+
+		/**
+		 * Match the entries of a configuration stream to the optional arguments that
+		 * have no value yet.
+		 */
+		void match_config(std::istream &in, String_View source, Parse_State &state) const;
+
+		/**
+		 * Fill the expanded arguments of the parse state from the command-line
+		 * arguments, replacing any response file arguments with the arguments read
+		 * from the files, and record the origin of each. The expanded arguments are
+		 * left empty if there are no response file arguments.
+		 */
+		Parse_Status expand_response_files(Parse_State &state, int argc, const char *const *argv) const;
+
+		/**
+		 * Append the argument, or the arguments read from the response file that it
+		 * names, to the expanded arguments.
+		 *
+		 * @param terminated  whether @a arg is null-terminated in place
+		 * @param arg_index   index of the command-line argument that @a arg was
+		 *                    expanded from
+		 * @param offset      offset of @a arg within the response file that it was
+		 *                    read from, or Parse_Status::NPOS for a command-line
+		 *                    argument
+		 */
+		Parse_Status expand_response_file_arg(Parse_State &state, String_View arg, bool terminated, int arg_index, std::size_t offset, unsigned depth) const;
+
+		/**
+		 * Assign the matched positional arguments to their corresponding parameters.
 		 */
-		std::pair<std::vector<const char *>, Matched_Opts> match_args(int argc, const char **argv) const {
-			std::vector<const char *> pos_args;
-			std::vector<Opt_Token> opt_args;
-			std::tie(pos_args, opt_args) = tokenize_args(argc, argv);
-			return std::make_pair(pos_args, match_opt_args(opt_args));
+		void assign_matched_pos(Parse_State &state) const {
+			CPPARSE_OBSERVE_PHASE(state, ASSIGN_POSITIONALS);
+			CPPARSE_COUNT(state, values, m_schema->positionals.size());
+			const auto count = m_schema->positionals.size();
+			for (std::size_t i = 0; i < count; ++i)
+				state.positionals[i].set_value(state.pos_args[i]);
 		}
 
 		/**
-		 * Match the tokenized arguments to their corresponding optional parameters.
+		 * Return the view that should be stored for the command-line value, copying
+		 * the value into the result's pool unless argv is being referenced directly.
+		 * Values read from response files are owned by the result and never copied.
+		 *
+		 * @param arg_index  index of the expanded argument holding the value
 		 */
-		Matched_Opts match_opt_args(const std::vector<Opt_Token> &arg_tokens) const {
-			auto optional_args = init_matched_opt_args(arg_tokens);
-			const std::string *p_last_optional;
-			for (const auto &token : arg_tokens) {
-				switch (token.type) {
-				case Opt_Token::Type::OPT_NAME:
-					p_last_optional = &token.value;
-					break;
-				case Opt_Token::Type::OPT_VAL:
-					optional_args[*p_last_optional].push_back(std::move(token.value));
-					break;
-				case Opt_Token::Type::FLAG:
-					optional_args[token.value].push_back("true");
-					break;
-				}
-			}
-			return optional_args;
+		String_View store_value(Parse_State &state, String_View value, int arg_index) const {
+			if (!m_copy_args || state.owns_arg(arg_index))
+				return value;
+			CPPARSE_COUNT(state, bytes_copied, value.size());
+			return state.pool.intern(value);
 		}
 
 		/**
-		 * Initialize the map used to store matched optional arguments.
+		 * Record an occurrence of the optional argument with the given value, split
+		 * at the argument's delimiter, if any. The fields refer to @a value, which
+		 * must already be stored unless the argument streams its values.
+		 *
+		 * @param arg_index  index of the command-line argument holding the value, or
+		 *                   -1 if it was not given on the command line
+		 * @return the parse status, failed if a streamed value cannot be converted
 		 */
-		Matched_Opts init_matched_opt_args(const std::vector<Opt_Token> &arg_tokens) const {
-			Matched_Opts optional_args;
-			const auto optional_counts = count_opt_args(arg_tokens);
-			optional_args.reserve(optional_counts.size());
-			for (const auto &pair : optional_counts)
-				optional_args[pair.first].reserve(pair.second);
-			return optional_args;
+		static Parse_Status add_values(Parse_State &state, const Optional_Info &optional, Optional_State &values, String_View value, int arg_index) {
+			if (!optional.has_delimiter())
+				return add_value(state, optional, values, value, arg_index);
+			Parse_Status status;
+			split_fields(value, optional.delimiter(), [&state, &optional, &values, &status, arg_index](String_View field) {
+				if (status)
+					status = add_value(state, optional, values, field, arg_index);
+			});
+			return status;
 		}
 
 		/**
-		 * Count the number of optional arguments from the token list.
+		 * Check the value against the optional argument's choices and range, then
+		 * pass it to the argument's on_value() callback if it has one, or store it
+		 * otherwise.
 		 */
-		std::unordered_map<std::string, std::size_t> count_opt_args(const std::vector<Opt_Token> &tokens) const {
-			std::unordered_map<std::string, std::size_t> optional_counts;
-			for (const auto &token : tokens) {
-				if (token.type == Opt_Token::Type::OPT_NAME || token.type == Opt_Token::Type::FLAG)
-					++optional_counts[token.value];
+		static Parse_Status add_value(Parse_State &state, const Optional_Info &optional, Optional_State &values, String_View value, int arg_index) {
+			CPPARSE_COUNT(state, values, 1);
+			auto choice = Name_Index::NPOS;
+			if (optional.has_choices()) {
+				choice = optional.m_choice_index.find(value);
+				if (choice == Name_Index::NPOS)
+					return parse_error(state, Parse_Errc::INVALID_CHOICE, arg_index).with_token(value).with_argument(optional.m_index, optional.name()).with_detail(optional.m_choice_list);
 			}
-			return optional_counts;
-		}
-
-		/**
-		 * Parse the command-line arguments into tokens that provide information for the
-		 * next parsing step.
-		 */
-		std::pair<std::vector<const char *>, std::vector<Opt_Token>> tokenize_args(int argc, const char **argv) const {
-			const std::vector<const char *> user_args(argv + 1, argv + argc);
-			std::vector<const char *> pos_args;
-			pos_args.reserve(user_args.size());
-			std::vector<Opt_Token> opt_tokens;
-			opt_tokens.reserve(user_args.size());
-
-			std::unordered_set<std::string> optional_names;
-			for (auto it = user_args.begin(); it != user_args.end(); ++it) {
-				auto optional_name = lookup_formatted_option_name(*it);
-				if (optional_name.empty()) {
-					pos_args.push_back(*it);
-				} else {
-					if (prematch_optional_arg(optional_name, optional_names.find(optional_name) != optional_names.end(), *std::next(it), *(user_args.end()))) {
-						opt_tokens.push_back(Opt_Token{Opt_Token::Type::OPT_NAME, optional_name});
-						opt_tokens.push_back(Opt_Token{Opt_Token::Type::OPT_VAL, *(++it)});
-					} else {
-						opt_tokens.push_back(Opt_Token{Opt_Token::Type::FLAG, optional_name});
-					}
-					optional_names.insert(optional_name);
-				}
+			if (optional.m_check_range) {
+				bool in_range;
+				/* A stored value's conversion is cached for retrieval as the range type */
+				const auto err = optional.m_check_range(state, optional.m_on_value ? nullptr : &values, value, in_range);
+				if (err != Convert_Error::NONE)
+					return parse_error(state, Parse_Errc::CONVERSION, arg_index).with_argument(optional.m_index, optional.name()).with_conversion(err, optional.m_range_error);
+				if (!in_range)
+					return parse_error(state, Parse_Errc::OUT_OF_RANGE, arg_index).with_token(value).with_argument(optional.m_index, optional.name()).with_detail(optional.m_range_text);
 			}
-			if (pos_args.size() < m_positional_order.size())
-				throw std::runtime_error{errstr("requires positional argument '", m_positional_order[pos_args.size()], "'")};
-
-			return std::make_pair(pos_args, opt_tokens);
+			if (!optional.m_on_value) {
+				values.add_value(value);
+				if (choice != Name_Index::NPOS)
+					values.choices.push_back(choice);
+				return Parse_Status{};
+			}
+			const auto err = optional.m_on_value(state, value);
+			if (err != Convert_Error::NONE)
+				return parse_error(state, Parse_Errc::CONVERSION, arg_index).with_argument(optional.m_index, optional.name()).with_conversion(err, optional.m_on_value_error);
+			values.add_occurrence();
+			return Parse_Status{};
 		}
 
 		/**
-		 * Look up the option name as either a flag or option argument and return the
-		 * formatted option name.
+		 * Attach the parser's observer to the parse state.
 		 */
-		std::string lookup_formatted_option_name(const std::string &option_name) const {
-			const auto flag_name = format_flag_name(option_name);
-			if (flag_name) {
-				const auto flag_it = m_flags.find(flag_name);
-				if (flag_it == m_flags.end())
-					throw std::runtime_error{errstr("invalid flag '", option_name, "', pass --help to display possible options")};
-				return flag_it->second;
-			}
-			return format_option_name(option_name);
+		void observe(Parse_State &state) const noexcept {
+#ifdef CPPARSE_INSTRUMENTATION
+			state.observer = m_observer;
+#else
+			static_cast<void>(state);
+#endif /* CPPARSE_INSTRUMENTATION */
 		}
 
 		/**
-		 * Perform initial validation/matching on the optional argument.
+		 * Report the counters of a successful parse to the observer.
 		 */
-		bool prematch_optional_arg(const std::string &option_name, bool repeated, const char *next_arg, const char *args_end) const {
-			if (m_auto_help && option_name == "help")
-				m_help_handler(*this);
+		static void report_parse(const Parse_State &state) noexcept {
+#ifdef CPPARSE_INSTRUMENTATION
+			if (state.observer)
+				state.observer->on_parse(state.counters);
+#else
+			static_cast<void>(state);
+#endif /* CPPARSE_INSTRUMENTATION */
+		}
 
-			auto it = m_optional_args.find(option_name);
-			if (it == m_optional_args.end())
-				throw std::runtime_error{errstr("invalid option '", option_name, "', pass --help to display possible options")};
+		/**
+		 * Look up the optional argument referred to by the lexed flag or option
+		 * token.
+		 *
+		 * Records (and optionally handles) a help request when the token refers to
+		 * the automatic help flag.
+		 *
+		 * @param arg_index  index of the command-line argument holding the token
+		 * @param opt_idx    set to the optional argument definition index
+		 * @return the parse status
+		 */
+		Parse_Status lookup_option_token(Parse_State &state, const Lexed_Token &token, int arg_index, String_View option_name, bool invoke_help, std::size_t &opt_idx) const;
 
-			if (it->second->type() == Optional_Info::Type::FLAG) {
-				if (repeated)
-					throw std::runtime_error{errstr("'", option_name, "' should only be specified once")};
-				return false;
-			} else {
-				if (next_arg == args_end)
-					throw std::runtime_error{errstr("'", option_name, "' requires a value")};
-				if (valid_option_name(next_arg))
-					throw std::runtime_error{errstr("'", option_name, "' requires a value")};
-				if (it->second->type() != Optional_Info::Type::APPEND && repeated)
-					throw std::runtime_error{errstr("'", option_name, "' should only be specified once")};
-				return true;
+		/**
+		 * Record a help request when the name is that of the automatic help flag,
+		 * invoking the help handler if requested.
+		 */
+		void note_help(Parse_State &state, String_View name, bool invoke_help) const {
+			if (m_auto_help && name == "help") {
+				state.help_requested = true;
+				if (invoke_help)
+					m_help_handler(*this);
 			}
 		}
 
 		/**
-		 * Update the command-line argument variables to refer to any extra positional
-		 * arguments that have not been matched.
+		 * Determine whether the lexed token is a cluster of short flags.
+		 *
+		 * @see lex_is_flag_cluster()
 		 */
-		void remove_matched(const std::vector<const char *> &extra_positional_args, int &argc, const char **&argv) const {
-			argc = extra_positional_args.size() + 1;
-			for (std::size_t i = 0; i < extra_positional_args.size(); ++i)
-				argv[i + 1] = extra_positional_args[i];
+		bool is_flag_cluster(const Lexed_Token &token, const char *arg) const noexcept {
+			return lex_is_flag_cluster(token, arg, [this](char flag) {
+				return m_schema->flags[static_cast<unsigned char>(flag)] != Name_Index::NPOS;
+			}, [this](const Lexed_Token &option) {
+				const auto ref = find_long_option(String_View{option.name, option.length});
+				return ref != Name_Index::NPOS && ref != Prefix_Index::AMBIGUOUS && !Argument_Schema::is_positional_ref(ref);
+			});
 		}
 
 		/**
-		 * Retrieve the value for the argument at the specified index with the given
-		 * default value.
+		 * Match the short flags of a cluster in place, one character at a time.
+		 *
+		 * Flag arguments are set as they are read. The first argument that takes a
+		 * value ends the cluster: the rest of the token is its value, or the next
+		 * command-line argument if the token ends there.
+		 *
+		 * @param token      lexed cluster token
+		 * @param arg_index  index of the command-line argument holding the cluster;
+		 *                   advanced past the value if the next argument is consumed
+		 * @return the parse status
 		 */
-		template<class T, bool has_default>
-		T arg_at(const std::string &name, std::size_t idx, T &&default_val) const {
-			const auto opt_it = m_optional_args.find(name);
-			if (opt_it != m_optional_args.cend())
-				return opt_it->second->as_type_at<T, has_default>(idx, std::forward<T>(default_val));
+		template<class Arg>
+		Parse_Status match_flag_cluster(Parse_State &state, const Lexed_Token &token, int argc, const Arg *args, int &arg_index, bool invoke_help) const;
 
-			const auto pos_it = m_positional_args.find(name);
-			if (pos_it != m_positional_args.cend())
-				return pos_it->second->as_type<T>();
+		/**
+		 * Look up the optional argument with the given long name, or with the name
+		 * that it abbreviates if abbreviations are allowed.
+		 *
+		 * @return the name reference as for Name_Index::find(), or
+		 *         Prefix_Index::AMBIGUOUS if the abbreviation matches several names
+		 */
+		std::uint32_t find_long_option(String_View name) const noexcept {
+			const auto ref = m_schema->names.find(name);
+			if (ref != Name_Index::NPOS || !m_allow_abbrev)
+				return ref;
+			return m_schema->long_names.find_prefix(name);
+		}
+
+		/**
+		 * Perform initial validation/matching on the optional argument.
+		 *
+		 * @a next_arg is null when the option is the last command-line argument.
+		 *
+		 * @param arg_index  index of the command-line argument holding the option
+		 * @param consume    set to true if the next argument should be consumed as
+		 *                   the option value
+		 * @return the parse status
+		 */
+		template<class Arg>
+		static Parse_Status prematch_optional_arg(const Parse_State &state, const Optional_Info &optional, const Optional_State &values, int arg_index, const Arg *next_arg, bool &consume) {
+			consume = optional.type() != Optional_Info::Type::FLAG;
+			if (consume && (next_arg == nullptr || lex_token(*next_arg).is_option()))
+				return parse_error(state, Parse_Errc::MISSING_VALUE, arg_index).with_argument(optional.m_index, optional.name());
+			if (!repeat_allowed(optional, values))
+				return parse_error(state, Parse_Errc::REPEATED_ARGUMENT, arg_index).with_argument(optional.m_index, optional.name());
+			return Parse_Status{};
+		}
 
-			throw std::logic_error{lerrstr("no argument by the name '", name, "'")};
+		/**
+		 * @return true if the optional argument may be given again, or false if it
+		 *         only accepts one value and already has it; repeated flags are
+		 *         counted
+		 */
+		static bool repeat_allowed(const Optional_Info &optional, const Optional_State &values) noexcept {
+			return values.occurrences == 0 || optional.type() != Optional_Info::Type::SINGLE;
 		}
 
-		const Optional_Info &lookup_optional(const std::string &name) const {
-			const auto opt_it = m_optional_args.find(name);
-			if (opt_it == m_optional_args.end())
-				throw std::logic_error{lerrstr("no optional argument by the name '", name, "'")};
-			return *opt_it->second;
+		/**
+		 * Fill the parse state from a snapshot, referring to the strings in place.
+		 */
+		void read_snapshot(const char *data, std::size_t size, Parse_State &state) const;
+
+		/**
+		 * Answer a '--cpparse-complete' request, splitting the words from the bash
+		 * completion variables when they are set.
+		 */
+		void complete_request(int argc, const char *const *argv);
+
+		/**
+		 * Hand out the lines of a parse_batch() call to a pool of threads in chunks
+		 * of BATCH_CHUNK, rethrowing the first exception that a thread encounters.
+		 *
+		 * @param count         number of lines
+		 * @param thread_count  number of threads to use, or 0 for one per core
+		 * @param parse_lines   function parsing the lines in [begin, end) using the
+		 *                      calling thread's scratch result
+		 */
+		void run_batch(std::size_t count, std::size_t thread_count, const std::function<void(Parse_Result &, std::size_t, std::size_t)> &parse_lines) const;
+
+		/**
+		 * Parse one parse_batch() command line into @a scratch, moving the result into
+		 * @a entry on success so that failed lines reuse the scratch storage.
+		 *
+		 * The error message of a failed line is formatted on demand, except when
+		 * response files are enabled: the offending text may then refer to a file
+		 * mapping or pooled copy that the next line releases.
+		 */
+		template<class Line>
+		void parse_batch_line(const Line &line, Parse_Result &scratch, Batch_Result &entry) const {
+			const auto status = try_parse(static_cast<int>(line.size()), line.data(), scratch);
+			if (!status) {
+				entry.m_status = status;
+				if (m_response_files)
+					entry.m_error = status.message();
+				return;
+			}
+			entry.m_result = std::move(scratch);
+			scratch = Parse_Result{m_result_resource};
 		}
 
-		Optional_Info &lookup_optional(const std::string &name) {
-			return const_cast<Optional_Info &>(static_cast<const Argument_Parser *>(this)->lookup_optional(name));
+		/**
+		 * Pass the arguments following the selected subcommand to its parser.
+		 *
+		 * The subcommand is parsed from a copy of its arguments in the parse state,
+		 * with a script name of "<script> <subcommand>" for its help and error
+		 * messages. @a argc and @a argv are updated to refer to the arguments it did
+		 * not match only if it succeeds.
+		 *
+		 * @return the parse status of the subcommand
+		 */
+		Parse_Status dispatch_subcommand(Parse_State &state, int &argc, const char **&argv);
+
+		/**
+		 * Update the command-line argument variables to refer to any extra positional
+		 * arguments that have not been matched.
+		 *
+		 * If response files expanded to more extra arguments than fit in @a argv,
+		 * @a argv is pointed at storage owned by the parse state instead.
+		 *
+		 * @param first  first of the unmatched arguments
+		 * @param last   end of the unmatched arguments
+		 */
+		static void remove_matched(Parse_State &state, const char *const *first, const char *const *last, int &argc, const char **&argv) {
+			const auto extra_count = static_cast<std::size_t>(last - first);
+			if (extra_count + 1 > static_cast<std::size_t>(argc)) {
+				state.remaining.push_back(argv[0]);
+				state.remaining.insert(state.remaining.end(), first, last);
+				argv = state.remaining.data();
+			} else {
+				for (auto it = first; it != last; ++it)
+					argv[it - first + 1] = *it;
+			}
+			argc = static_cast<int>(extra_count + 1);
 		}
 
 	};
 
 }
 
+#ifndef CPPARSE_COMPILED_LIB
+#include "cparseparse/argument-parser-impl.h"
+#endif /* CPPARSE_COMPILED_LIB */
+
 #endif /* CPARSEPARSE_ARGUMENT_PARSER */
@@ -0,0 +1,91 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_ARGUMENT_SCHEMA_H_
+#define CPARSEPARSE_ARGUMENT_SCHEMA_H_
+
+#include "cparseparse/optional-info.h"
+#include "cparseparse/positional-info.h"
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/name-index.h"
+#include "cparseparse/util/prefix-index.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+
+namespace cpparse {
+
+	/**
+	 * Argument definitions of an Argument_Parser.
+	 *
+	 * The schema is built by the parser's add_positional()/add_optional() calls and
+	 * is only read while parsing, so that any number of Parse_Result objects can be
+	 * filled concurrently from the same schema.
+	 */
+	struct Argument_Schema {
+
+		/** Name index value bit marking a positional argument reference */
+		static constexpr std::uint32_t POSITIONAL_REF{0x80000000u};
+
+		/**
+		 * Construct empty schema.
+		 *
+		 * @param resource  memory resource that the definition tables are allocated from
+		 */
+		explicit Argument_Schema(Memory_Resource *resource)
+				: positionals(Resource_Allocator<Positional_Info>{resource}),
+				  optionals(Resource_Allocator<Optional_Info>{resource}),
+				  names{resource},
+				  long_names{resource},
+				  env_names{resource} {
+			flags.fill(std::uint32_t{Name_Index::NPOS});
+		}
+
+		static std::uint32_t positional_ref(std::size_t index) noexcept {
+			return static_cast<std::uint32_t>(index) | POSITIONAL_REF;
+		}
+
+		static bool is_positional_ref(std::uint32_t ref) noexcept {
+			return (ref & POSITIONAL_REF) != 0;
+		}
+
+		static std::size_t ref_index(std::uint32_t ref) noexcept {
+			return ref & ~POSITIONAL_REF;
+		}
+
+		/**
+		 * Compute a hash of the argument names and types, identifying the schema
+		 * that a parse snapshot was taken from.
+		 */
+		std::uint64_t fingerprint() const noexcept {
+			std::uint64_t hash{hash_name(String_View{})};
+			const auto mix = [&hash](std::uint64_t value) {
+				hash ^= value;
+				hash *= 1099511628211ull;
+			};
+			for (const auto &positional : positionals)
+				mix(hash_name(positional.name()));
+			mix(positionals.size());
+			for (const auto &optional : optionals) {
+				mix(hash_name(optional.name()));
+				mix(static_cast<std::uint64_t>(optional.type()));
+			}
+			mix(optionals.size());
+			return hash;
+		}
+
+		std::deque<Positional_Info, Resource_Allocator<Positional_Info>> positionals;
+		std::deque<Optional_Info, Resource_Allocator<Optional_Info>> optionals;
+		Name_Index names;
+		Prefix_Index long_names;  // optional argument names, for abbreviations and completion
+		Name_Index env_names;     // environment variables read by optional arguments
+		std::array<std::uint32_t, 128> flags;
+		std::uint64_t revision{0};  // advanced by each change to the definitions shown in the help text
+	};
+
+}
+
+#endif /* CPARSEPARSE_ARGUMENT_SCHEMA_H_ */
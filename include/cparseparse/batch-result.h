@@ -0,0 +1,71 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_BATCH_RESULT_H_
+#define CPARSEPARSE_BATCH_RESULT_H_
+
+#include "cparseparse/parse-result.h"
+#include "cparseparse/parse-status.h"
+#include <string>
+
+namespace cpparse {
+
+	/**
+	 * Outcome of parsing one command line with Argument_Parser::parse_batch().
+	 *
+	 * Holds either the parse result or the parse status. Failed lines do not
+	 * allocate any parse state, and their error message is only formatted when
+	 * error() is first called.
+	 */
+	class Batch_Result {
+	public:
+
+		/**
+		 * @return true if the command line was parsed successfully, or false otherwise
+		 */
+		bool ok() const noexcept {
+			return m_status.ok();
+		}
+
+		/**
+		 * @return the status of the parse; see Parse_Status for the lifetime of the
+		 *         strings that it refers to
+		 */
+		const Parse_Status &status() const noexcept {
+			return m_status;
+		}
+
+		/**
+		 * Format the error message on first use.
+		 *
+		 * Must not be called concurrently for the same result.
+		 *
+		 * @return the error message, or an empty string if the line was parsed successfully
+		 */
+		const std::string &error() const {
+			if (m_error.empty() && !m_status.ok())
+				m_error = m_status.message();
+			return m_error;
+		}
+
+		/**
+		 * @return the parse result; unfilled if the line failed to parse
+		 */
+		const Parse_Result &result() const noexcept {
+			return m_result;
+		}
+
+	private:
+		friend class Argument_Parser;
+
+		Parse_Result m_result;
+		Parse_Status m_status;
+		mutable std::string m_error;
+	};
+
+}
+
+#endif /* CPARSEPARSE_BATCH_RESULT_H_ */
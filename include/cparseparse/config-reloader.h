@@ -0,0 +1,201 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_CONFIG_RELOADER_H_
+#define CPARSEPARSE_CONFIG_RELOADER_H_
+
+#include "cparseparse/argument-parser.h"
+#include "cparseparse/parse-result.h"
+#include "cparseparse/util/compat.h"
+#include "cparseparse/util/errstr.h"
+#include "cparseparse/util/file-stamp.h"
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cpparse {
+
+	/**
+	 * Holder of the arguments of a long-running program, re-reading its
+	 * configuration files on request.
+	 *
+	 * The command line is parsed once and combined with the configuration files
+	 * as by Argument_Parser::parse_config_file(), with the files read in the given
+	 * order. Each call to reload() re-reads only the files whose identity, size or
+	 * modification time changed, rebuilds the result when the contents differ, and
+	 * reports which optional arguments changed value.
+	 *
+	 * The result is published as an immutable snapshot: current() hands out a
+	 * shared pointer to the latest result, and a reload swaps in a new one without
+	 * disturbing readers that still hold the previous one. current() may be called
+	 * from any thread; reload() must not be called concurrently with itself. The
+	 * parser and the reloader must outlive every snapshot handed out.
+	 */
+	class Config_Reloader {
+	public:
+
+		/**
+		 * Parse the command line and read the configuration files.
+		 *
+		 * @param parser  parser whose argument definitions to match against
+		 * @param argc    command-line argument count
+		 * @param argv    command-line argument strings; copied
+		 * @param paths   configuration file paths, in order of precedence
+		 * @throw std::runtime_error  If the command line cannot be parsed, or a
+		 *                            file cannot be read or does not match the
+		 *                            argument definitions.
+		 */
+		Config_Reloader(const Argument_Parser &parser, int argc, const char *const *argv, std::vector<std::string> paths)
+				: m_parser{&parser},
+				  m_args(argv, argv + argc) {
+			m_argv.reserve(m_args.size());
+			for (const auto &arg : m_args)
+				m_argv.push_back(arg.c_str());
+			m_sources.reserve(paths.size());
+			for (auto &path : paths) {
+				Source source;
+				source.path = std::move(path);
+				if (!read_source(source))
+					throw_unreadable(source.path);
+				m_sources.push_back(std::move(source));
+			}
+			m_current = build(m_sources);
+		}
+
+		/* Disable copy and move operations */
+		Config_Reloader(const Config_Reloader &) = delete;
+		Config_Reloader &operator=(const Config_Reloader &) = delete;
+
+		/**
+		 * @return the latest result
+		 */
+		std::shared_ptr<const Parse_Result> current() const {
+			std::lock_guard<std::mutex> lock{m_mutex};
+			return m_current;
+		}
+
+		/**
+		 * Re-read the configuration files that changed and publish the new result.
+		 *
+		 * Nothing is re-parsed if no file changed. The on_value() callbacks of the
+		 * arguments run again when the result is rebuilt; such arguments count as
+		 * changed when the number of times they were given changes.
+		 *
+		 * @return the reference names of the optional arguments whose values
+		 *         changed, in definition order
+		 * @throw std::runtime_error  If a file cannot be read or does not match the
+		 *                            argument definitions. The current result and
+		 *                            the recorded file states are kept, so the next
+		 *                            reload tries again.
+		 */
+		std::vector<std::string> reload() {
+			auto sources = m_sources;
+			bool changed{false};
+			for (std::size_t i = 0; i < sources.size(); ++i) {
+				if (File_Stamp::of(sources[i].path.c_str()) == m_sources[i].stamp)
+					continue;
+				if (!read_source(sources[i]))
+					throw_unreadable(sources[i].path);
+				changed = changed || sources[i].contents != m_sources[i].contents;
+			}
+			if (!changed) {
+				/* Record the new stamps so that touched files are not read again */
+				m_sources = std::move(sources);
+				return std::vector<std::string>{};
+			}
+
+			auto next = build(sources);
+			const auto previous = current();
+			auto changed_names = changed_args(*previous, *next);
+			{
+				std::lock_guard<std::mutex> lock{m_mutex};
+				m_current = std::move(next);
+			}
+			m_sources = std::move(sources);
+			return changed_names;
+		}
+
+	private:
+
+		/** Configuration file and the contents last read from it */
+		struct Source {
+			std::string path;
+			File_Stamp stamp;
+			std::string contents;
+		};
+
+		const Argument_Parser *m_parser;
+		std::vector<std::string> m_args;
+		std::vector<const char *> m_argv;
+		std::vector<Source> m_sources;
+		mutable std::mutex m_mutex;
+		std::shared_ptr<const Parse_Result> m_current;
+
+		/**
+		 * Read the file of a source, taking the stamp before the contents so that a
+		 * write during the read is noticed by the next reload.
+		 *
+		 * @return true if the file was read, or false otherwise
+		 */
+		static bool read_source(Source &source) {
+			source.stamp = File_Stamp::of(source.path.c_str());
+			std::ifstream in{source.path, std::ios::binary};
+			if (!in)
+				return false;
+			std::ostringstream contents;
+			contents << in.rdbuf();
+			if (in.bad())
+				return false;
+			source.contents = contents.str();
+			return true;
+		}
+
+		/**
+		 * Parse the command line and the contents of the sources into a new result.
+		 */
+		std::shared_ptr<const Parse_Result> build(const std::vector<Source> &sources) const {
+			auto result = std::make_shared<Parse_Result>();
+			m_parser->parse(static_cast<int>(m_argv.size()), m_argv.data(), *result);
+			for (const auto &source : sources) {
+				std::istringstream in{source.contents};
+				m_parser->parse_config(in, *result, source.path);
+			}
+			return result;
+		}
+
+		/**
+		 * @return the reference names of the optional arguments whose values differ
+		 *         between the results
+		 */
+		static std::vector<std::string> changed_args(const Parse_Result &previous, const Parse_Result &next) {
+			const auto &optionals = next.schema().optionals;
+			std::vector<std::string> names;
+			for (std::size_t i = 0; i < optionals.size(); ++i) {
+				const auto &before = previous.m_state->optionals[i];
+				const auto &after = next.m_state->optionals[i];
+				bool same = before.occurrences == after.occurrences && before.values.size() == after.values.size();
+				for (std::size_t j = 0; same && j < after.values.size(); ++j)
+					same = before.values[j].compare(after.values[j]) == 0;
+				if (!same)
+					names.push_back(optionals[i].name());
+			}
+			return names;
+		}
+
+		[[noreturn]] void throw_unreadable(const std::string &path) const {
+			CPPARSE_THROW(std::runtime_error{errstr(m_args.empty() ? String_View{} : String_View{m_args[0]}, "cannot open configuration file '", path, "'")});
+		}
+	};
+
+}
+
+#endif /* CPARSEPARSE_CONFIG_RELOADER_H_ */
@@ -0,0 +1,225 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_CONVERTERS_H_
+#define CPARSEPARSE_CONVERTERS_H_
+
+#include "cparseparse/util/convert.h"
+#include "cparseparse/util/string-view.h"
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ratio>
+#include <string>
+#include <type_traits>
+
+namespace cpparse {
+
+	/**
+	 * Size in bytes, converted from values such as @p 4096, @p 512K, @p 1.5G or
+	 * @p 64MiB.
+	 *
+	 * The suffixes K, M, G, T, P and E (in either case, optionally followed by
+	 * @p iB or @p B) are powers of 1024. A fractional size is rounded down to a
+	 * whole number of bytes.
+	 */
+	struct Byte_Size {
+		constexpr Byte_Size(std::uint64_t bytes = 0) noexcept
+				: bytes{bytes} { }
+
+		constexpr operator std::uint64_t() const noexcept {
+			return bytes;
+		}
+
+		std::uint64_t bytes;
+	};
+
+	/**
+	 * Helpers for the converters below.
+	 */
+	inline const char *_convert_digits_end(const char *first, const char *last) noexcept {
+		while (first != last && _convert_is_digit(*first))
+			++first;
+		return first;
+	}
+
+	/**
+	 * Convert a duration such as @p 90s or @p 1h30m to a count of nanoseconds.
+	 */
+	inline Convert_Error _convert_duration_ns(String_View value, std::int64_t &out) noexcept {
+		const char *first = value.data(), *last = first + value.size();
+		if (first == last)
+			return Convert_Error::INVALID;
+		std::int64_t total{0};
+		while (first != last) {
+			const auto digits_end = _convert_digits_end(first, last);
+			if (digits_end == first)
+				return Convert_Error::INVALID;
+			std::int64_t count{0};
+			const auto err = _convert_integer(first, digits_end, count);
+			if (err != Convert_Error::NONE)
+				return err;
+			first = digits_end;
+			if (first == last)
+				return Convert_Error::INVALID;
+
+			std::int64_t unit;
+			const auto next = first + 1 != last ? first[1] : '\0';
+			if (*first == 'n' && next == 's') {
+				unit = 1;
+				++first;
+			} else if (*first == 'u' && next == 's') {
+				unit = 1000;
+				++first;
+			} else if (*first == 'm' && next == 's') {
+				unit = 1000000;
+				++first;
+			} else if (*first == 's') {
+				unit = 1000000000;
+			} else if (*first == 'm') {
+				unit = 60 * 1000000000ll;
+			} else if (*first == 'h') {
+				unit = 3600 * 1000000000ll;
+			} else if (*first == 'd') {
+				unit = 86400 * 1000000000ll;
+			} else {
+				return Convert_Error::INVALID;
+			}
+			++first;
+			if (count > (std::numeric_limits<std::int64_t>::max() - total) / unit)
+				return Convert_Error::OUT_OF_RANGE;
+			total += count * unit;
+		}
+		out = total;
+		return Convert_Error::NONE;
+	}
+
+	/**
+	 * @return the duration suffix naming one tick of @a Period, or null if there
+	 *         is none
+	 */
+	template<class Period>
+	const char *_convert_duration_unit() noexcept {
+		return std::ratio_equal<Period, std::nano>::value ? "1ns"
+				: std::ratio_equal<Period, std::micro>::value ? "1us"
+				: std::ratio_equal<Period, std::milli>::value ? "1ms"
+				: std::ratio_equal<Period, std::ratio<1>>::value ? "1s"
+				: std::ratio_equal<Period, std::ratio<60>>::value ? "1m"
+				: std::ratio_equal<Period, std::ratio<3600>>::value ? "1h"
+				: std::ratio_equal<Period, std::ratio<86400>>::value ? "1d"
+				: nullptr;
+	}
+
+	/**
+	 * Converter for std::chrono durations, from values such as @p 500ms, @p 90s or
+	 * @p 1h30m.
+	 *
+	 * A value is a sequence of counts, each followed by one of the units ns, us,
+	 * ms, s, m (minutes), h or d, and is at most about 292 years long. A duration
+	 * with an integral representation rejects values that are not a whole number
+	 * of its ticks, rather than truncating them.
+	 */
+	template<class Rep, class Period>
+	struct converter<std::chrono::duration<Rep, Period>> {
+		using Duration = std::chrono::duration<Rep, Period>;
+
+		static Convert_Error convert(String_View value, Duration &out) noexcept {
+			std::int64_t ns{0};
+			const auto err = _convert_duration_ns(value, ns);
+			if (err != Convert_Error::NONE)
+				return err;
+			const std::chrono::nanoseconds total{ns};
+			const auto ticks = std::chrono::duration_cast<std::chrono::duration<long double, Period>>(total).count();
+			if (ticks > static_cast<long double>(std::numeric_limits<Rep>::max()))
+				return Convert_Error::OUT_OF_RANGE;
+			if (std::chrono::treat_as_floating_point<Rep>::value) {
+				out = Duration{static_cast<Rep>(ticks)};
+				return Convert_Error::NONE;
+			}
+			const auto converted = std::chrono::duration_cast<Duration>(total);
+			if (std::chrono::duration_cast<std::chrono::nanoseconds>(converted) != total)
+				return Convert_Error::INVALID;
+			out = converted;
+			return Convert_Error::NONE;
+		}
+
+		static std::string error(String_View name, Convert_Error err) {
+			if (err == Convert_Error::OUT_OF_RANGE)
+				return "'" + to_string(name) + "' is too long";
+			const auto unit = _convert_duration_unit<Period>();
+			std::string message{"'" + to_string(name) + "' must be a duration such as 1h30m or 90s"};
+			if (unit && !std::chrono::treat_as_floating_point<Rep>::value)
+				message.append(", in multiples of ").append(unit);
+			return message;
+		}
+	};
+
+	/**
+	 * Converter for Byte_Size.
+	 */
+	template<>
+	struct converter<Byte_Size> {
+		static Convert_Error convert(String_View value, Byte_Size &out) noexcept {
+			const char *first = value.data(), *last = first + value.size();
+			const auto digits_end = _convert_digits_end(first, last);
+			if (digits_end == first)
+				return Convert_Error::INVALID;
+			std::uint64_t whole{0};
+			const auto err = _convert_integer(first, digits_end, whole);
+			if (err != Convert_Error::NONE)
+				return err;
+			first = digits_end;
+
+			long double fraction{0};
+			if (first != last && *first == '.') {
+				const auto fraction_end = _convert_digits_end(++first, last);
+				if (fraction_end == first)
+					return Convert_Error::INVALID;
+				long double scale{1};
+				for (; first != fraction_end; ++first)
+					fraction += (*first - '0') * (scale /= 10);
+			}
+
+			unsigned shift{0};
+			if (first != last) {
+				static const char SUFFIXES[]{"KMGTPE"};
+				const char upper = 'a' <= *first && *first <= 'z' ? static_cast<char>(*first - 'a' + 'A') : *first;
+				for (unsigned i = 0; SUFFIXES[i] != '\0'; ++i) {
+					if (SUFFIXES[i] == upper)
+						shift = 10 * (i + 1);
+				}
+				if (shift != 0) {
+					++first;
+					if (first != last && *first == 'i')
+						++first;
+				}
+				if (first != last && *first == 'B')
+					++first;
+				if (first != last)
+					return Convert_Error::INVALID;
+			}
+
+			const std::uint64_t max{std::numeric_limits<std::uint64_t>::max()};
+			if (whole > (max >> shift))
+				return Convert_Error::OUT_OF_RANGE;
+			const auto bytes = whole << shift;
+			const auto extra = static_cast<std::uint64_t>(fraction * static_cast<long double>(std::uint64_t{1} << shift));
+			if (extra > max - bytes)
+				return Convert_Error::OUT_OF_RANGE;
+			out = Byte_Size{bytes + extra};
+			return Convert_Error::NONE;
+		}
+
+		static std::string error(String_View name, Convert_Error err) {
+			if (err == Convert_Error::OUT_OF_RANGE)
+				return "'" + to_string(name) + "' is too large";
+			return "'" + to_string(name) + "' must be a size such as 4096, 512K or 4G";
+		}
+	};
+
+}
+
+#endif /* CPARSEPARSE_CONVERTERS_H_ */
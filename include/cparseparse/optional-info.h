@@ -9,8 +9,13 @@
 
 #include "cparseparse/argument-info.h"
 #include "cparseparse/util/compat.h"
+#include "cparseparse/util/name-index.h"
 #include "cparseparse/util/string-ops.h"
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
 #include <vector>
 
 namespace cpparse {
@@ -27,7 +32,8 @@ namespace cpparse {
 		 * Optional argument type.
 		 *
 		 * FLAG    flag argument; arg() returns true when present or false
-		 *         otherwise.
+		 *         otherwise. A flag may be repeated (for example, @p -vvv), and
+		 *         arg_count() returns the number of times it was given.
 		 *
 		 * SINGLE  optional argument with a single value.
 		 *
@@ -40,14 +46,17 @@ namespace cpparse {
 		/**
 		 * Construct optional argument info.
 		 *
-		 * @param name  argument name
-		 * @param type  optional argument type
+		 * @param name   argument name
+		 * @param type   optional argument type
+		 * @param state  state filled by the owning parser's parse_args()
 		 */
 		template<class String>
-		explicit Optional_Info(String &&name, Type type) noexcept(noexcept(Argument_Info{std::forward<String>(name)}))
+		explicit Optional_Info(String &&name, Type type, const Parse_State &state) noexcept(noexcept(Argument_Info{std::forward<String>(name)}))
 				: Argument_Info{std::forward<String>(name)},
 				  m_flag{NO_FLAG},
-				  m_type{type} { }
+				  m_delimiter{NO_DELIMITER},
+				  m_type{type},
+				  m_state{&state} { }
 
 		/**
 		 * Implicit conversion to bool.
@@ -79,18 +88,246 @@ namespace cpparse {
 			return m_type;
 		}
 
+		/**
+		 * Retrieve a typed handle to this argument.
+		 *
+		 * The handle can be passed to the Argument_Parser query functions in place of
+		 * the argument name to skip the name lookup.
+		 *
+		 * @tparam T  type that the argument values are retrieved as
+		 * @return the argument handle
+		 */
+		template<class T>
+		Arg_Handle<T> handle() const noexcept {
+			return Arg_Handle<T>{Arg_Handle<T>::Kind::OPTIONAL, m_index};
+		}
+
+		/**
+		 * @return true if a delimiter is associated with this argument, or false
+		 *         otherwise
+		 */
+		bool has_delimiter() const noexcept {
+			return m_delimiter != NO_DELIMITER;
+		}
+
+		/**
+		 * @return the delimiter that separates the values given in a single argument
+		 */
+		char delimiter() const noexcept {
+			return m_delimiter;
+		}
+
+		/**
+		 * Accept a list of values separated by the delimiter in each occurrence of
+		 * the argument, as in @p --ids 1,2,3.
+		 *
+		 * Each field is stored as a separate value, so that as_type_all() and
+		 * arg_at() see the same values as for repeated occurrences, and count()
+		 * reports the number of fields. An argument of type SINGLE may still only be
+		 * given once, but its value may hold several fields.
+		 *
+		 * @param delim  value delimiter, or @p '\0' to accept a single value per
+		 *               occurrence
+		 * @return a reference to this object
+		 * @throw std::logic_error  If the argument is a FLAG type argument.
+		 */
+		Optional_Info &delimiter(char delim) {
+			if (m_type == Type::FLAG)
+				CPPARSE_THROW(std::logic_error{lerrstr("flag argument '", m_name, "' cannot take delimited values")});
+			m_delimiter = delim;
+			touch();
+			return *this;
+		}
+
+		/**
+		 * @return the environment variable that supplies the argument when it is
+		 *         not given on the command line, or an empty string if there is none
+		 */
+		const std::string &env() const noexcept {
+			return m_env;
+		}
+
+		/**
+		 * Fall back to the value of the environment variable when the argument is
+		 * not given on the command line.
+		 *
+		 * The declared variables of a parser are all resolved in a single pass over
+		 * the environment during parsing. The value is used as if it had been given
+		 * once on the command line (and is split at the delimiter, if any), but it
+		 * refers into the environment block rather than being copied, so the
+		 * environment must not be modified while the parsed values are in use. A FLAG
+		 * argument is set when the variable holds a true boolean value, such as
+		 * @p true or @p yes.
+		 *
+		 * @tparam String  string-like type that is convertible to @a std::string
+		 * @param name     environment variable name
+		 * @return a reference to this object
+		 * @throw std::logic_error  If the argument already has an environment
+		 *                          variable, or the variable is used by another
+		 *                          argument.
+		 */
+		template<class String>
+		Optional_Info &env(String &&name) {
+			if (!m_env.empty())
+				CPPARSE_THROW(std::logic_error{lerrstr("'", m_name, "' already reads environment variable '", m_env, "'")});
+			std::string env_name{std::forward<String>(name)};
+			if (env_name.empty() || env_name.find('=') != std::string::npos)
+				CPPARSE_THROW(std::logic_error{lerrstr("invalid environment variable name '", env_name, "'")});
+			if (m_env_names->find(env_name) != Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("environment variable '", env_name, "' is already read by another argument")});
+			m_env = std::move(env_name);
+			m_env_names->insert(m_env, static_cast<std::uint32_t>(m_index));
+			touch();
+			return *this;
+		}
+
+		/**
+		 * Stream the argument values to a callback as they are matched, instead of
+		 * storing them.
+		 *
+		 * Each value is converted to type @a T and passed to @a callback during
+		 * parsing, so memory use does not grow with the number of occurrences. The
+		 * values are not retained: count() and exists() report the occurrences, but
+		 * the value accessors behave as if no value was given. A String_View value is
+		 * only valid for the duration of the call. When the parser is used from
+		 * multiple threads, the callback is called concurrently.
+		 *
+		 * @tparam T         type to convert the values to
+		 * @tparam Callback  callable type taking a value of type @a T
+		 * @param callback   callable invoked with each value
+		 * @return a reference to this object
+		 * @throw std::runtime_error  (from parsing) If a value cannot be parsed as type
+		 *                            @a T.
+		 */
+		template<class T, class Callback>
+		Optional_Info &on_value(Callback &&callback) {
+			const typename std::decay<Callback>::type value_callback{std::forward<Callback>(callback)};
+			m_on_value = [this, value_callback](const Parse_Context &context, String_View value) {
+				CPPARSE_OBSERVE_CONVERSION(context, m_name, 1);
+				auto out = _convert_target<T>();
+				const auto err = convert_value<T>(value, out);
+				if (err == Convert_Error::NONE)
+					value_callback(std::move(out));
+				return err;
+			};
+			m_on_value_error = &conversion_error<T>;
+			return *this;
+		}
+
+		/**
+		 * @return true if the argument values are restricted to a list of choices,
+		 *         or false otherwise
+		 */
+		bool has_choices() const noexcept {
+			return !m_choices.empty();
+		}
+
+		/**
+		 * @return the values that the argument is restricted to, in the order given
+		 *         to choices()
+		 */
+		const std::vector<std::string> &choices() const noexcept {
+			return m_choices;
+		}
+
+		/**
+		 * Restrict the argument values to the given choices.
+		 *
+		 * Each value is looked up in a hash table of the choices as it is matched,
+		 * and a value that is not one of them is reported as a parse error. The
+		 * position of each matched value in the list is recorded, so that choice()
+		 * retrieves it later without comparing strings. The choices are also shown
+		 * in the help text and offered by shell completion.
+		 *
+		 * @tparam Range  range of string-like values convertible to @a std::string
+		 * @param values  allowed values
+		 * @return a reference to this object
+		 * @throw std::logic_error  If the argument is a FLAG type argument, or the
+		 *                          list is empty or holds duplicate values.
+		 */
+		template<class Range>
+		Optional_Info &choices(const Range &values) {
+			if (m_type == Type::FLAG)
+				CPPARSE_THROW(std::logic_error{lerrstr("flag argument '", m_name, "' cannot have choices")});
+			std::vector<std::string> list;
+			for (const auto &value : values)
+				list.emplace_back(value);
+			if (list.empty())
+				CPPARSE_THROW(std::logic_error{lerrstr("no choices given for '", m_name, "'")});
+			Name_Index index;
+			for (std::size_t i = 0; i < list.size(); ++i) {
+				if (!index.insert(list[i], static_cast<std::uint32_t>(i)))
+					CPPARSE_THROW(std::logic_error{lerrstr("duplicate choice '", list[i], "' for '", m_name, "'")});
+			}
+			m_choice_list.clear();
+			for (const auto &choice : list) {
+				if (!m_choice_list.empty())
+					m_choice_list += ", ";
+				m_choice_list += choice;
+			}
+			/* The index refers to the strings, which do not move with the vector */
+			m_choices = std::move(list);
+			m_choice_index = std::move(index);
+			touch();
+			return *this;
+		}
+
+		/**
+		 * @see choices()
+		 */
+		Optional_Info &choices(std::initializer_list<String_View> values) {
+			return choices<std::initializer_list<String_View>>(values);
+		}
+
+		/**
+		 * Restrict the argument values to the inclusive range [min, max].
+		 *
+		 * Each value is converted to type @a T and checked as it is matched, and a
+		 * value that cannot be converted or is out of range is reported as a parse
+		 * error. The converted values are kept, so retrieving them as type @a T
+		 * does not convert them again.
+		 *
+		 * @tparam T   arithmetic type to check the values as
+		 * @param min  smallest allowed value
+		 * @param max  largest allowed value
+		 * @return a reference to this object
+		 * @throw std::logic_error  If the argument is a FLAG type argument, or
+		 *                          @a min is greater than @a max.
+		 */
+		template<class T>
+		Optional_Info &range(T min, T max) {
+			static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "range() requires a numeric type");
+			if (m_type == Type::FLAG)
+				CPPARSE_THROW(std::logic_error{lerrstr("flag argument '", m_name, "' cannot have a range")});
+			if (max < min)
+				CPPARSE_THROW(std::logic_error{lerrstr("invalid range for '", m_name, "'")});
+			m_range_text.clear();
+			_errstr(m_range_text, "[", +min, ",", +max, "]");
+			m_check_range = [this, min, max](const Parse_Context &context, Optional_State *store, String_View value, bool &in_range) {
+				CPPARSE_OBSERVE_CONVERSION(context, m_name, 1);
+				T out{};
+				const auto err = convert_value<T>(value, out);
+				in_range = err == Convert_Error::NONE && !(out < min) && !(max < out);
+				if (in_range && store)
+					store->cache.append(out);
+				return err;
+			};
+			m_range_error = &conversion_error<T>;
+			return *this;
+		}
+
 		/**
 		 * @return the number of values given for the argument.
 		 */
 		std::size_t count() const noexcept {
-			return m_values.size();
+			return state().occurrences;
 		}
 
 		/**
 		 * @return true if the argument was specified by the user, or false otherwise.
 		 */
 		bool exists() const noexcept {
-			return !m_values.empty();
+			return state().occurrences > 0;
 		}
 
 		/**
@@ -105,6 +342,30 @@ namespace cpparse {
 			return as_type_at<T>(0);
 		}
 
+		/**
+		 * Retrieve the position of the argument value in the choices() list.
+		 *
+		 * @return the index of the value among the choices
+		 * @throw std::logic_error   if the argument has no choices
+		 * @throw std::out_of_range  if no value was given for the argument
+		 */
+		std::size_t choice() const {
+			return choice_at(0);
+		}
+
+		/**
+		 * Retrieve the position of the argument value at the given index in the
+		 * choices() list.
+		 *
+		 * @param idx  index at which to retrieve value
+		 * @return the index of the value among the choices
+		 * @throw std::logic_error   if the argument has no choices
+		 * @throw std::out_of_range  if the index is out-of-range for the argument
+		 */
+		std::size_t choice_at(std::size_t idx) const {
+			return choice_at(state(), idx);
+		}
+
 		/**
 		 * Retrieve the argument as a value of type @a T.
 		 *
@@ -130,7 +391,7 @@ namespace cpparse {
 		 */
 		template<class T>
 		T as_type_at(std::size_t idx) const {
-			return as_type_at<T, false>(idx, T{});
+			return as_type_at<T, false>(state(), idx, _convert_target<T>());
 		}
 
 		/**
@@ -146,7 +407,7 @@ namespace cpparse {
 		 */
 		template<class T>
 		T as_type_at(std::size_t idx, T &&default_val) const {
-			return as_type_at<T, true>(idx, std::forward<T>(default_val));
+			return as_type_at<T, true>(state(), idx, std::forward<T>(default_val));
 		}
 
 		/**
@@ -161,72 +422,177 @@ namespace cpparse {
 		 */
 		template<class T>
 		std::vector<T> as_type_all() const {
-			std::vector<T> values;
-			values.reserve(count());
-			for (std::size_t i = 0; i < count(); ++i)
-				values.push_back(as_type_at<T>(i));
-			return values;
+			return as_type_all_ref<T>(state());
+		}
+
+		/**
+		 * Retrieve a reference to the list of values that the user supplied for the
+		 * given argument.
+		 *
+		 * Behaves like as_type_all(), but the parsed values are cached on first use and
+		 * the same vector is returned on later calls with the same type @a T. The
+		 * reference is valid until the arguments are parsed again.
+		 *
+		 * @tparam T  type to parse arguments as
+		 * @return a reference to a vector containing the user-supplied values parsed as type @a T
+		 * @throw std::runtime_error  if the argument cannot be parsed as type @a T
+		 */
+		template<class T>
+		const std::vector<T> &as_type_all_ref() const {
+			return as_type_all_ref<T>(state());
 		}
 
 		/**
-		 * Print argument description.
+		 * Append the argument names and value placeholder shown in the help text,
+		 * such as @p "-o, --output OUTPUT".
 		 *
-		 * @param text_width  text width spacing
-		 * @param out         output stream
+		 * @param out  string to append to
 		 */
-		void print(std::size_t text_width, std::ostream &out = std::cout) const {
-			std::stringstream ss;
+		void append_label(std::string &out) const {
 			if (has_flag())
-				ss << "-" << m_flag << ", ";
-			ss << "--" << m_name;
-			if (m_type != Type::FLAG)
-				ss << " " << str_to_upper(m_name);
-			print_help(ss.str(), text_width, out);
+				out.append(1, '-').append(1, m_flag).append(", ");
+			out.append("--").append(m_name);
+			if (has_choices()) {
+				out.append(" {");
+				for (std::size_t i = 0; i < m_choices.size(); ++i)
+					out.append(i == 0 ? "" : ",").append(m_choices[i]);
+				out.push_back('}');
+			} else if (m_type != Type::FLAG) {
+				out.push_back(' ');
+				append_upper(out, m_name);
+			}
+			if (has_delimiter())
+				out.append(1, '[').append(1, m_delimiter).append("...]");
 		}
 
+		/**
+		 * Append the help text, followed by the environment variable if there is
+		 * one.
+		 *
+		 * @param out  string to append to
+		 */
+		void append_help(std::string &out) const {
+			out.append(m_help_text);
+			if (!m_env.empty())
+				out.append(m_help_text.empty() ? "" : " ").append("[env: ").append(m_env).push_back(']');
+		}
+
+
 	private:
 		friend class Argument_Parser;
+		friend class Parse_Result;
 
 		/** Special constant to indicate that there is no associated flag */
 		static constexpr char NO_FLAG{0};
 
+		/** Special constant to indicate that there is no value delimiter */
+		static constexpr char NO_DELIMITER{0};
+
 		char m_flag;
+		char m_delimiter;
 		Type m_type;
-		std::vector<std::string> m_values;
+		const Parse_State *m_state;
+		Name_Index *m_env_names{nullptr};
+		std::string m_env;
+		std::function<Convert_Error(const Parse_Context &, String_View)> m_on_value;
+		std::string (*m_on_value_error)(String_View, String_View, Convert_Error){nullptr};
+		std::vector<std::string> m_choices;
+		Name_Index m_choice_index;
+		std::string m_choice_list;
+		std::function<Convert_Error(const Parse_Context &, Optional_State *, String_View, bool &)> m_check_range;
+		std::string m_range_text;
+		std::string (*m_range_error)(String_View, String_View, Convert_Error){nullptr};
 
 		/**
-		 * Retrieve the argument at the given index as a value of type @a T.
+		 * @return the values matched to this argument by parse_args()
+		 */
+		const Optional_State &state() const noexcept {
+			return m_state->optionals[m_index];
+		}
+
+		/**
+		 * Retrieve the argument at the given index of the parse state as a value of type @a T.
 		 *
 		 * If the argument was not specified by the user but a default value was given, the default value is used.
 		 *
 		 * @tparam T            type to retrieve the argument as
 		 * @tparam has_default  compile-time boolean indicating whether a default value was given
+		 * @param state         values matched to this argument
 		 * @param idx           index at which to retrieve value
 		 * @param default_val   default value to use if the argument was not specified by the user
 		 * @return the argument as a value of type @a T
 		 * @throw std::logic_error  if no value was provided for the argument
 		 */
 		template<class T, bool has_default>
-		T as_type_at(std::size_t idx, T &&default_val) const {
-			if (exists())
-				return parse_as_type<T>(value(idx));
+		T as_type_at(const Optional_State &state, std::size_t idx, T &&default_val) const {
+			if (!state.values.empty())
+				return cached_as_type<T>(*state.context, state.cache, state.values.data(), state.values.size(), check_index(state, idx));
 			IF_CONSTEXPR (has_default)
 				return std::forward<T>(default_val);
 			if (m_type == Type::FLAG)
-				return parse_as_type<T>("false");
-			throw std::logic_error{lerrstr("no value given for '", m_name, "' and no default specified")};
+				return parse_as_type<T>(*state.context, "false");
+			CPPARSE_THROW(std::logic_error{lerrstr("no value given for '", m_name, "' and no default specified")});
+		}
+
+		/**
+		 * Retrieve the argument value at the given index of the parse state without
+		 * throwing, leaving @a out unchanged if there is no value at the index.
+		 */
+		template<class T>
+		Parse_Status try_as_type_at(const Optional_State &state, std::size_t idx, T &out) const {
+			if (idx >= state.values.size())
+				return Parse_Status{};
+			return try_cached_as_type<T>(*state.context, state.cache, state.values.data(), state.values.size(), idx, out);
+		}
+
+		/**
+		 * Retrieve a reference to the cached list of values in the parse state.
+		 *
+		 * @see as_type_all_ref()
+		 */
+		template<class T>
+		const std::vector<T> &as_type_all_ref(const Optional_State &state) const {
+			const auto &cached = cached_values<T>(*state.context, state.cache, state.values.data(), state.values.size());
+			if (!cached.complete) {
+				for (std::size_t i = 0; i < state.values.size(); ++i) {
+					if (!cached.converted(i))
+						parse_as_type<T>(*state.context, state.values[i]);
+				}
+			}
+			return cached.values;
 		}
 
 		/**
-		 * Retrieve the argument value at the given index.
+		 * Retrieve the choice index of the value at the given index of the parse
+		 * state.
 		 *
-		 * @return the argument value as a string
+		 * @see choice_at()
+		 */
+		std::size_t choice_at(const Optional_State &state, std::size_t idx) const {
+			check_choices();
+			return state.choices[check_index(state, idx)];
+		}
+
+		/**
+		 * Check that the argument values are restricted to a list of choices.
+		 *
+		 * @throw std::logic_error  if the argument has no choices
+		 */
+		void check_choices() const {
+			if (!has_choices())
+				CPPARSE_THROW(std::logic_error{lerrstr("'", m_name, "' does not have choices")});
+		}
+
+		/**
+		 * Check that the index refers to one of the argument values.
+		 *
+		 * @return the index
 		 * @throw std::out_of_range  if the index is out-of-range for the argument
 		 */
-		std::string value(std::size_t idx) const {
-			if (idx >= m_values.size())
-				throw std::out_of_range{lerrstr("index ", idx, " is out of range for '", m_name, "'")};
-			return m_values[idx];
+		std::size_t check_index(const Optional_State &state, std::size_t idx) const {
+			if (idx >= state.values.size())
+				CPPARSE_THROW(std::out_of_range{lerrstr("index ", idx, " is out of range for '", m_name, "'")});
+			return idx;
 		}
 
 		/* Private functions for Argument_Parser */
@@ -241,12 +607,21 @@ namespace cpparse {
 		}
 
 		/**
-		 * Set the values for this optional argument.
+		 * Set the definition index of this optional argument.
+		 *
+		 * @param index  definition index
+		 */
+		void set_index(std::size_t index) noexcept {
+			m_index = index;
+		}
+
+		/**
+		 * Set the index of environment variable names that env() registers with.
 		 *
-		 * @param values  vector of values
+		 * @param env_names  environment variable name index of the owning parser
 		 */
-		void set_values(std::vector<std::string> &&values) noexcept(std::is_nothrow_move_assignable<std::vector<std::string>>::value) {
-			m_values = std::move(values);
+		void set_env_index(Name_Index &env_names) noexcept {
+			m_env_names = &env_names;
 		}
 
 	};
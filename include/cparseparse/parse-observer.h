@@ -0,0 +1,158 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_PARSE_OBSERVER_H_
+#define CPARSEPARSE_PARSE_OBSERVER_H_
+
+#ifdef CPPARSE_INSTRUMENTATION
+
+#include "cparseparse/util/string-view.h"
+#include <chrono>
+#include <cstddef>
+
+namespace cpparse {
+
+	/**
+	 * Internal phase of a parse.
+	 *
+	 * EXPAND_RESPONSE_FILES  reading and tokenizing '@path' response files.
+	 *
+	 * MATCH_ARGS             lexing the command-line arguments and storing the
+	 *                        option values, in a single pass.
+	 *
+	 * READ_ENVIRONMENT       scanning the environment for the variables read by
+	 *                        optional arguments.
+	 *
+	 * ASSIGN_POSITIONALS     storing the positional argument values.
+	 *
+	 * READ_CONFIG            reading a configuration file or stream.
+	 */
+	enum class Parse_Phase { EXPAND_RESPONSE_FILES, MATCH_ARGS, READ_ENVIRONMENT, ASSIGN_POSITIONALS, READ_CONFIG };
+
+	/**
+	 * Counters accumulated over a single parse.
+	 */
+	struct Parse_Counters {
+		std::size_t tokens{0};        // command-line arguments lexed
+		std::size_t values{0};        // argument values stored
+		std::size_t bytes_copied{0};  // bytes of values copied out of argv
+	};
+
+	/**
+	 * Observer of parse timings and counters.
+	 *
+	 * Only available when the library is compiled with @p CPPARSE_INSTRUMENTATION
+	 * defined; otherwise, the hooks compile to nothing. Install an observer with
+	 * Argument_Parser::Options::observer(). The functions may be called from
+	 * multiple threads at once when the parser is used concurrently, and must not
+	 * throw.
+	 */
+	class Parse_Observer {
+	public:
+		virtual ~Parse_Observer() = default;
+
+		/**
+		 * Called when a phase of a parse completes, including by an exception.
+		 *
+		 * @param phase    completed phase
+		 * @param elapsed  time spent in the phase
+		 */
+		virtual void on_phase(Parse_Phase, std::chrono::nanoseconds) noexcept { }
+
+		/**
+		 * Called when a parse of the command-line arguments succeeds.
+		 *
+		 * @param counters  counters accumulated over the parse
+		 */
+		virtual void on_parse(const Parse_Counters &) noexcept { }
+
+		/**
+		 * Called when argument values are converted to a requested type.
+		 *
+		 * @param name     argument name
+		 * @param count    number of values converted
+		 * @param elapsed  time spent converting
+		 */
+		virtual void on_conversion(String_View, std::size_t, std::chrono::nanoseconds) noexcept { }
+	};
+
+	/**
+	 * Scoped timer that reports a phase to the observer, if any, on destruction.
+	 */
+	class Phase_Timer {
+	public:
+		Phase_Timer(Parse_Observer *observer, Parse_Phase phase) noexcept
+				: m_observer{observer},
+				  m_phase{phase},
+				  m_start{observer ? Clock::now() : Clock::time_point{}} { }
+
+		Phase_Timer(const Phase_Timer &) = delete;
+		Phase_Timer &operator=(const Phase_Timer &) = delete;
+
+		~Phase_Timer() {
+			if (m_observer)
+				m_observer->on_phase(m_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start));
+		}
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		Parse_Observer *m_observer;
+		Parse_Phase m_phase;
+		Clock::time_point m_start;
+	};
+
+	/**
+	 * Scoped timer that reports a conversion to the observer, if any, on
+	 * destruction.
+	 */
+	class Conversion_Timer {
+	public:
+		Conversion_Timer(Parse_Observer *observer, String_View name, std::size_t count) noexcept
+				: m_observer{observer},
+				  m_name{name},
+				  m_count{count},
+				  m_start{observer ? Clock::now() : Clock::time_point{}} { }
+
+		Conversion_Timer(const Conversion_Timer &) = delete;
+		Conversion_Timer &operator=(const Conversion_Timer &) = delete;
+
+		~Conversion_Timer() {
+			if (m_observer)
+				m_observer->on_conversion(m_name, m_count, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start));
+		}
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		Parse_Observer *m_observer;
+		String_View m_name;
+		std::size_t m_count;
+		Clock::time_point m_start;
+	};
+
+}
+
+/** Time the rest of the enclosing scope as the given phase */
+#define CPPARSE_OBSERVE_PHASE(context, phase) \
+	const ::cpparse::Phase_Timer _cpparse_phase_timer{(context).observer, ::cpparse::Parse_Phase::phase}
+
+/** Time the rest of the enclosing scope as a conversion of @a count values */
+#define CPPARSE_OBSERVE_CONVERSION(context, name, count) \
+	const ::cpparse::Conversion_Timer _cpparse_conversion_timer{(context).observer, name, count}
+
+/** Add @a n to the named counter of the parse */
+#define CPPARSE_COUNT(context, counter, n) ((context).counters.counter += (n))
+
+#else
+
+#define CPPARSE_OBSERVE_PHASE(context, phase) static_cast<void>(context)
+#define CPPARSE_OBSERVE_CONVERSION(context, name, count) static_cast<void>(context)
+#define CPPARSE_COUNT(context, counter, n) static_cast<void>(0)
+
+#endif /* CPPARSE_INSTRUMENTATION */
+
+#endif /* CPARSEPARSE_PARSE_OBSERVER_H_ */
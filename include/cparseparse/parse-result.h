@@ -0,0 +1,405 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_PARSE_RESULT_H_
+#define CPARSEPARSE_PARSE_RESULT_H_
+
+#include "cparseparse/argument-schema.h"
+#include "cparseparse/parse-state.h"
+#include "cparseparse/parse-status.h"
+#include "cparseparse/util/errstr.h"
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/snapshot.h"
+#include "cparseparse/util/string-view.h"
+#include <stdexcept>
+#include <vector>
+
+namespace cpparse {
+
+	/**
+	 * Values matched by a single call to Argument_Parser::parse().
+	 *
+	 * A result refers to the argument definitions of the parser that filled it and
+	 * must not outlive that parser. Queries take the same form as the
+	 * Argument_Parser query functions. Results can be reused for subsequent parses,
+	 * retaining their allocated storage.
+	 */
+	class Parse_Result {
+	public:
+
+		/**
+		 * Construct empty result.
+		 *
+		 * The parse state is allocated by the first parse into the result.
+		 *
+		 * @param resource  memory resource that the parse state is allocated from
+		 */
+		explicit Parse_Result(Memory_Resource *resource = nullptr) noexcept
+				: m_resource{resource} { }
+
+		/**
+		 * @return the script name (the first command-line argument)
+		 */
+		String_View script_name() const noexcept {
+			return m_state ? m_state->script_name : String_View{};
+		}
+
+		/**
+		 * Determine whether '-h/--help' was given.
+		 *
+		 * Parses into a result never invoke the parser's help handler; instead, the
+		 * request is recorded here and the check for missing positional arguments is
+		 * skipped.
+		 *
+		 * @return true if help was requested, or false otherwise
+		 */
+		bool help_requested() const noexcept {
+			return m_state && m_state->help_requested;
+		}
+
+		/**
+		 * @return the name of the selected subcommand, or an empty string if none was
+		 *         selected
+		 */
+		String_View subcommand() const noexcept {
+			return m_state ? m_state->subcommand : String_View{};
+		}
+
+		/**
+		 * @return the number of extra positional arguments not matched by the
+		 *         defined positional arguments
+		 */
+		std::size_t extra_count() const noexcept {
+			return m_state ? m_state->extra_args.size() : 0;
+		}
+
+		/**
+		 * @return the extra positional arguments not matched by the defined
+		 *         positional arguments
+		 */
+		const char *const *extra_args() const noexcept {
+			return m_state ? m_state->extra_args.data() : nullptr;
+		}
+
+		/**
+		 * @see Argument_Parser::has_arg()
+		 */
+		bool has_arg(String_View name) const {
+			return m_state->optionals[optional_index(name)].occurrences > 0;
+		}
+
+		/**
+		 * @see Argument_Parser::arg()
+		 */
+		template<class T>
+		T arg(String_View name) const {
+			return arg_at<T>(name, 0);
+		}
+
+		/**
+		 * @see Argument_Parser::arg()
+		 */
+		template<class T>
+		T arg(String_View name, T &&default_val) const {
+			return arg_at<T>(name, 0, std::forward<T>(default_val));
+		}
+
+		/**
+		 * @see Argument_Parser::args()
+		 */
+		template<class T>
+		std::vector<T> args(String_View name) const {
+			return args_ref<T>(name);
+		}
+
+		/**
+		 * @see Argument_Parser::args_ref()
+		 */
+		template<class T>
+		const std::vector<T> &args_ref(String_View name) const {
+			const auto idx = optional_index(name);
+			return schema().optionals[idx].as_type_all_ref<T>(m_state->optionals[idx]);
+		}
+
+		/**
+		 * @see Argument_Parser::arg_at()
+		 */
+		template<class T>
+		T arg_at(String_View name, std::size_t idx) const {
+			return arg_at<T, false>(name, idx, _convert_target<T>());
+		}
+
+		/**
+		 * @see Argument_Parser::arg_at()
+		 */
+		template<class T>
+		T arg_at(String_View name, std::size_t idx, T &&default_val) const {
+			return arg_at<T, true>(name, idx, std::forward<T>(default_val));
+		}
+
+		/**
+		 * @see Argument_Parser::arg_count()
+		 */
+		std::size_t arg_count(String_View name) const {
+			return m_state->optionals[optional_index(name)].occurrences;
+		}
+
+		/**
+		 * @see Argument_Parser::choice()
+		 */
+		std::size_t choice(String_View name) const {
+			return choice_at(name, 0);
+		}
+
+		/**
+		 * @see Argument_Parser::choice()
+		 */
+		std::size_t choice(String_View name, std::size_t default_choice) const {
+			const auto idx = optional_index(name);
+			const auto &optional = schema().optionals[idx];
+			optional.check_choices();
+			return m_state->optionals[idx].occurrences > 0 ? optional.choice_at(m_state->optionals[idx], 0) : default_choice;
+		}
+
+		/**
+		 * @see Argument_Parser::choice_at()
+		 */
+		std::size_t choice_at(String_View name, std::size_t idx) const {
+			const auto opt_idx = optional_index(name);
+			return schema().optionals[opt_idx].choice_at(m_state->optionals[opt_idx], idx);
+		}
+
+		/**
+		 * @see Argument_Parser::has_arg()
+		 */
+		template<class T>
+		bool has_arg(const Arg_Handle<T> &handle) const {
+			return m_state->optionals[optional_index(handle)].occurrences > 0;
+		}
+
+		/**
+		 * @see Argument_Parser::arg()
+		 */
+		template<class T>
+		T arg(const Arg_Handle<T> &handle) const {
+			return arg_at(handle, 0);
+		}
+
+		/**
+		 * @see Argument_Parser::arg()
+		 */
+		template<class T>
+		T arg(const Arg_Handle<T> &handle, const typename Arg_Handle<T>::Value &default_val) const {
+			return arg_at(handle, 0, default_val);
+		}
+
+		/**
+		 * @see Argument_Parser::args()
+		 */
+		template<class T>
+		std::vector<T> args(const Arg_Handle<T> &handle) const {
+			return args_ref(handle);
+		}
+
+		/**
+		 * @see Argument_Parser::args_ref()
+		 */
+		template<class T>
+		const std::vector<T> &args_ref(const Arg_Handle<T> &handle) const {
+			const auto idx = optional_index(handle);
+			return schema().optionals[idx].template as_type_all_ref<T>(m_state->optionals[idx]);
+		}
+
+		/**
+		 * @see Argument_Parser::arg_at()
+		 */
+		template<class T>
+		T arg_at(const Arg_Handle<T> &handle, std::size_t idx) const {
+			if (handle.kind() == Arg_Handle<T>::Kind::POSITIONAL) {
+				const auto pos_idx = positional_index(handle);
+				return schema().positionals[pos_idx].template as_type<T>(m_state->positionals[pos_idx]);
+			}
+			const auto opt_idx = optional_index(handle);
+			return schema().optionals[opt_idx].template as_type_at<T, false>(m_state->optionals[opt_idx], idx, _convert_target<T>());
+		}
+
+		/**
+		 * @see Argument_Parser::arg_at()
+		 */
+		template<class T>
+		T arg_at(const Arg_Handle<T> &handle, std::size_t idx, const typename Arg_Handle<T>::Value &default_val) const {
+			if (handle.kind() == Arg_Handle<T>::Kind::POSITIONAL) {
+				const auto pos_idx = positional_index(handle);
+				return schema().positionals[pos_idx].template as_type<T>(m_state->positionals[pos_idx]);
+			}
+			const auto opt_idx = optional_index(handle);
+			return schema().optionals[opt_idx].template as_type_at<T, true>(m_state->optionals[opt_idx], idx, T(default_val));
+		}
+
+		/**
+		 * @see Argument_Parser::arg_count()
+		 */
+		template<class T>
+		std::size_t arg_count(const Arg_Handle<T> &handle) const {
+			return m_state->optionals[optional_index(handle)].occurrences;
+		}
+
+		/**
+		 * @see Argument_Parser::try_arg()
+		 */
+		template<class T>
+		Parse_Status try_arg(String_View name, T &out) const {
+			return try_arg_at(name, 0, out);
+		}
+
+		/**
+		 * @see Argument_Parser::try_arg_at()
+		 */
+		template<class T>
+		Parse_Status try_arg_at(String_View name, std::size_t idx, T &out) const {
+			const auto &schema = this->schema();
+			const auto ref = schema.names.find(name);
+			if (ref == Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("no argument by the name '", name, "'")});
+			if (Argument_Schema::is_positional_ref(ref)) {
+				const auto pos_idx = Argument_Schema::ref_index(ref);
+				return schema.positionals[pos_idx].try_as_type<T>(m_state->positionals[pos_idx], out);
+			}
+			return schema.optionals[ref].try_as_type_at<T>(m_state->optionals[ref], idx, out);
+		}
+
+		/**
+		 * Serialize the matched values into a compact binary snapshot.
+		 *
+		 * The snapshot holds the script name, the selected subcommand, and the raw
+		 * values of every argument, and can be loaded with
+		 * Argument_Parser::load_snapshot() by a parser with the same argument
+		 * definitions, for example in a child process or a worker thread. It is
+		 * versioned and uses the host byte order, so it is not meant to be portable
+		 * between machines.
+		 *
+		 * @return the snapshot bytes
+		 * @throw std::logic_error  If the result has not been filled by a parser.
+		 */
+		std::vector<char> snapshot() const {
+			const auto &schema = this->schema();
+			const auto &state = *m_state;
+			std::vector<char> out;
+			Snapshot_Writer writer{out};
+			writer.write_u32(SNAPSHOT_MAGIC);
+			writer.write_u32(SNAPSHOT_VERSION);
+			writer.write_u64(schema.fingerprint());
+			writer.write_u32(static_cast<std::uint32_t>(schema.positionals.size()));
+			writer.write_u32(static_cast<std::uint32_t>(schema.optionals.size()));
+			writer.write_u32(state.help_requested ? 1 : 0);
+			writer.write_string(state.script_name);
+			writer.write_string(state.subcommand);
+			for (std::size_t i = 0; i < schema.positionals.size(); ++i)
+				writer.write_string(state.positionals[i].value);
+			for (std::size_t i = 0; i < schema.optionals.size(); ++i) {
+				const auto &optional = state.optionals[i];
+				writer.write_u32(static_cast<std::uint32_t>(optional.occurrences));
+				writer.write_u32(static_cast<std::uint32_t>(optional.values.size()));
+				for (const auto &value : optional.values)
+					writer.write_string(value);
+			}
+			writer.write_u32(static_cast<std::uint32_t>(extra_count()));
+			for (const auto arg : state.extra_args)
+				writer.write_string(arg);
+			return out;
+		}
+
+	private:
+		friend class Argument_Parser;
+		friend class Config_Reloader;
+
+		Memory_Resource *m_resource;
+		const Argument_Schema *m_schema{nullptr};
+		Resource_Ptr<Parse_State> m_state;
+
+		/**
+		 * Retrieve the parse state, allocating it on first use.
+		 */
+		Parse_State &state() {
+			if (!m_state)
+				m_state = make_resource_unique<Parse_State>(m_resource, m_resource);
+			return *m_state;
+		}
+
+		const Argument_Schema &schema() const {
+			if (!m_schema || !m_state)
+				CPPARSE_THROW(std::logic_error{lerrstr("result has not been filled by a parser")});
+			return *m_schema;
+		}
+
+		/**
+		 * Retrieve the value for the argument at the specified index with the given
+		 * default value.
+		 */
+		template<class T, bool has_default>
+		T arg_at(String_View name, std::size_t idx, T &&default_val) const {
+			const auto &schema = this->schema();
+			const auto ref = schema.names.find(name);
+			if (ref == Name_Index::NPOS)
+				CPPARSE_THROW(std::logic_error{lerrstr("no argument by the name '", name, "'")});
+			if (Argument_Schema::is_positional_ref(ref)) {
+				const auto pos_idx = Argument_Schema::ref_index(ref);
+				return schema.positionals[pos_idx].as_type<T>(m_state->positionals[pos_idx]);
+			}
+			return schema.optionals[ref].as_type_at<T, has_default>(m_state->optionals[ref], idx, std::forward<T>(default_val));
+		}
+
+		std::size_t optional_index(String_View name) const {
+			const auto ref = schema().names.find(name);
+			if (ref == Name_Index::NPOS || Argument_Schema::is_positional_ref(ref))
+				CPPARSE_THROW(std::logic_error{lerrstr("no optional argument by the name '", name, "'")});
+			return ref;
+		}
+
+		template<class T>
+		std::size_t optional_index(const Arg_Handle<T> &handle) const {
+			if (handle.kind() != Arg_Handle<T>::Kind::OPTIONAL || handle.index() >= schema().optionals.size())
+				CPPARSE_THROW(std::logic_error{lerrstr("handle does not refer to an optional argument")});
+			return handle.index();
+		}
+
+		template<class T>
+		std::size_t positional_index(const Arg_Handle<T> &handle) const {
+			if (handle.kind() != Arg_Handle<T>::Kind::POSITIONAL || handle.index() >= schema().positionals.size())
+				CPPARSE_THROW(std::logic_error{lerrstr("handle does not refer to a positional argument")});
+			return handle.index();
+		}
+
+	};
+
+/*
+ * Value types whose conversions are instantiated once in libcparseparse.a,
+ * rather than in every translation unit, when CPPARSE_COMPILED_LIB is defined.
+ */
+#define CPPARSE_LIBRARY_VALUE_TYPES(X) \
+	X(bool) X(char) X(int) X(long) X(long long) \
+	X(unsigned int) X(unsigned long) X(unsigned long long) \
+	X(float) X(double) X(std::string) X(String_View)
+
+/*
+ * Explicit instantiations (@a prefix empty) or instantiation declarations
+ * (@a prefix extern) of the Parse_Result conversion functions for type T.
+ */
+#define CPPARSE_PARSE_RESULT_INSTANTIATIONS(prefix, T) \
+	prefix template T Parse_Result::arg_at<T, false>(String_View, std::size_t, T &&) const; \
+	prefix template T Parse_Result::arg_at<T, true>(String_View, std::size_t, T &&) const; \
+	prefix template const std::vector<T> &Parse_Result::args_ref<T>(String_View) const; \
+	prefix template Parse_Status Parse_Result::try_arg_at<T>(String_View, std::size_t, T &) const;
+
+#ifdef CPPARSE_COMPILED_LIB
+#define CPPARSE_EXTERN_PARSE_RESULT(T) CPPARSE_PARSE_RESULT_INSTANTIATIONS(extern, T)
+	CPPARSE_LIBRARY_VALUE_TYPES(CPPARSE_EXTERN_PARSE_RESULT)
+#undef CPPARSE_EXTERN_PARSE_RESULT
+#endif /* CPPARSE_COMPILED_LIB */
+
+}
+
+#endif /* CPARSEPARSE_PARSE_RESULT_H_ */
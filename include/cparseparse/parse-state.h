@@ -0,0 +1,223 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_PARSE_STATE_H_
+#define CPARSEPARSE_PARSE_STATE_H_
+
+#include "cparseparse/parse-observer.h"
+#include "cparseparse/parse-status.h"
+#include "cparseparse/util/mapped-file.h"
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/string-pool.h"
+#include "cparseparse/util/string-view.h"
+#include "cparseparse/util/value-cache.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace cpparse {
+
+	/**
+	 * Context shared by the argument states of a single parse.
+	 */
+	struct Parse_Context {
+		/** Script name used to prefix error messages */
+		String_View script_name;
+#ifdef CPPARSE_INSTRUMENTATION
+
+		/** Observer of the parse, or null */
+		Parse_Observer *observer{nullptr};
+
+		/** Counters accumulated over the parse */
+		Parse_Counters counters;
+#endif /* CPPARSE_INSTRUMENTATION */
+	};
+
+	/**
+	 * Position in the caller's arguments of an argument expanded from them.
+	 *
+	 * An argument read from a response file is owned by the parse state: it is a
+	 * view into the file's mapping, or an unescaped copy in the string pool.
+	 */
+	struct Arg_Origin {
+		int arg_index;       // index of the argument, or of the '@path' argument it was read from
+		std::size_t offset;  // offset within the innermost response file, or Parse_Status::NPOS
+		bool terminated;     // whether the argument is null-terminated in place
+	};
+
+	/**
+	 * Values matched to an optional argument by a single parse.
+	 */
+	struct Optional_State {
+		Optional_State(const Parse_Context &context, Memory_Resource *resource) noexcept
+				: context{&context},
+				  values(Resource_Allocator<String_View>{resource}),
+				  choices(Resource_Allocator<std::uint32_t>{resource}),
+				  cache{resource} { }
+
+		/**
+		 * Record an occurrence of the argument with the given value.
+		 */
+		void add_value(String_View value) {
+			values.push_back(value);
+			++occurrences;
+		}
+
+		/**
+		 * Record an occurrence of the argument whose value is not stored.
+		 */
+		void add_occurrence() noexcept {
+			++occurrences;
+		}
+
+		/**
+		 * Clear the matched values, keeping the allocated storage.
+		 */
+		void clear() noexcept {
+			values.clear();
+			choices.clear();
+			occurrences = 0;
+			cache.clear();
+		}
+
+		const Parse_Context *context;
+		Resource_Vector<String_View> values;
+		Resource_Vector<std::uint32_t> choices;  // choice index of each value, if the argument has choices
+		std::size_t occurrences{0};
+		mutable Value_Cache cache;
+	};
+
+	/**
+	 * Value matched to a positional argument by a single parse.
+	 */
+	struct Positional_State {
+		Positional_State(const Parse_Context &context, Memory_Resource *resource) noexcept
+				: context{&context},
+				  cache{resource} { }
+
+		/**
+		 * Set the matched value.
+		 */
+		void set_value(String_View new_value) noexcept {
+			value = new_value;
+			cache.clear();
+		}
+
+		const Parse_Context *context;
+		String_View value;
+		mutable Value_Cache cache;
+	};
+
+	/**
+	 * State filled by a single parse.
+	 *
+	 * The state is kept at a stable address so that the argument states can refer
+	 * to it as their shared context.
+	 */
+	struct Parse_State : Parse_Context {
+		explicit Parse_State(Memory_Resource *resource)
+				: resource{resource},
+				  positionals(Resource_Allocator<Positional_State>{resource}),
+				  optionals(Resource_Allocator<Optional_State>{resource}),
+				  pos_args(Resource_Allocator<String_View>{resource}),
+				  extra_args(Resource_Allocator<const char *>{resource}),
+				  args(Resource_Allocator<String_View>{resource}),
+				  arg_origins(Resource_Allocator<Arg_Origin>{resource}),
+				  remaining(Resource_Allocator<const char *>{resource}),
+				  subcommand_args(Resource_Allocator<const char *>{resource}),
+				  files(Resource_Allocator<Mapped_File>{resource}),
+				  pool{resource} { }
+
+		/**
+		 * Add argument states for any arguments defined after the last parse.
+		 *
+		 * @param positional_count  number of defined positional arguments
+		 * @param optional_count    number of defined optional arguments
+		 */
+		void bind(std::size_t positional_count, std::size_t optional_count) {
+			if (positionals.size() < positional_count) {
+				positionals.reserve(positional_count);
+				while (positionals.size() < positional_count)
+					positionals.emplace_back(*this, resource);
+			}
+			if (optionals.size() < optional_count) {
+				optionals.reserve(optional_count);
+				while (optionals.size() < optional_count)
+					optionals.emplace_back(*this, resource);
+			}
+		}
+
+		/**
+		 * Clear the parsed values, keeping the allocated storage.
+		 */
+		void clear() noexcept {
+			clear_values();
+			files.clear();
+			pool.clear();
+		}
+
+		/**
+		 * Clear the parsed values after a failed parse, keeping the response files
+		 * and copied strings that a failed Parse_Status may refer to until the next
+		 * parse.
+		 */
+		void clear_values() noexcept {
+			for (auto &optional : optionals)
+				optional.clear();
+			for (auto &positional : positionals)
+				positional.set_value(String_View{});
+			pos_args.clear();
+			extra_args.clear();
+			args.clear();
+			arg_origins.clear();
+			remaining.clear();
+			subcommand_args.clear();
+			script_name = String_View{};
+			invoked_name = String_View{};
+			subcommand = String_View{};
+#ifdef CPPARSE_INSTRUMENTATION
+			counters = Parse_Counters{};
+#endif /* CPPARSE_INSTRUMENTATION */
+			help_requested = false;
+		}
+
+		/**
+		 * @return true if the expanded argument was read from a response file, and
+		 *         so is owned by the parse state, or false otherwise
+		 */
+		bool owns_arg(int arg_index) const noexcept {
+			return static_cast<std::size_t>(arg_index) < arg_origins.size() && arg_origins[arg_index].offset != Parse_Status::NPOS;
+		}
+
+		/**
+		 * @return the expanded argument as a null-terminated string, copied into the
+		 *         pool if it is not null-terminated in place
+		 */
+		const char *arg_c_str(int arg_index) {
+			if (static_cast<std::size_t>(arg_index) >= arg_origins.size() || arg_origins[arg_index].terminated)
+				return args[arg_index].data();
+			CPPARSE_COUNT(*this, bytes_copied, args[arg_index].size());
+			return pool.intern(args[arg_index]).data();
+		}
+
+		Memory_Resource *resource;
+		Resource_Vector<Positional_State> positionals;
+		Resource_Vector<Optional_State> optionals;
+		Resource_Vector<String_View> pos_args;    // arguments matched to the positional arguments
+		Resource_Vector<const char *> extra_args; // positional arguments beyond those defined
+		Resource_Vector<String_View> args;        // argv with response files expanded
+		Resource_Vector<Arg_Origin> arg_origins;  // position of each of args in argv, if expanded
+		Resource_Vector<const char *> remaining;  // unmatched arguments returned from parse_args()
+		Resource_Vector<const char *> subcommand_args;  // arguments passed to the subcommand's parser
+		Resource_Vector<Mapped_File> files;       // response files referenced by the arguments
+		String_Pool pool;
+		String_View invoked_name;  // argv[0] as passed to the parse, for parse errors
+		String_View subcommand;    // name of the selected subcommand
+		bool help_requested{false};
+	};
+
+}
+
+#endif /* CPARSEPARSE_PARSE_STATE_H_ */
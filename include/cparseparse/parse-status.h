@@ -0,0 +1,277 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_PARSE_STATUS_H_
+#define CPARSEPARSE_PARSE_STATUS_H_
+
+#include "cparseparse/util/convert.h"
+#include "cparseparse/util/errstr.h"
+#include "cparseparse/util/prefix-index.h"
+#include "cparseparse/util/string-view.h"
+#include <cstddef>
+#include <string>
+
+namespace cpparse {
+
+	/**
+	 * Parse error code.
+	 *
+	 * INVALID_FLAG         a short flag that is not defined, on its own or in a
+	 *                      cluster.
+	 *
+	 * INVALID_OPTION       a long option that is not defined.
+	 *
+	 * AMBIGUOUS_OPTION     an abbreviated long option that matches several
+	 *                      options.
+	 *
+	 * MISSING_VALUE        an option that takes a value is not followed by one.
+	 *
+	 * REPEATED_ARGUMENT    a non-append option is given more than once.
+	 *
+	 * MISSING_POSITIONAL   fewer positional arguments than defined are given.
+	 *
+	 * INVALID_COMMAND      the argument in the subcommand position does not name a
+	 *                      subcommand.
+	 *
+	 * INVALID_ENVIRONMENT  the environment variable of a flag does not hold a
+	 *                      boolean value.
+	 *
+	 * RESPONSE_FILE_DEPTH  response files are nested too deeply.
+	 *
+	 * CONVERSION           an argument value cannot be converted to the requested
+	 *                      type.
+	 *
+	 * INVALID_CHOICE       an argument value is not one of the argument's choices.
+	 *
+	 * OUT_OF_RANGE         an argument value is outside of the argument's range.
+	 */
+	enum class Parse_Errc {
+		NONE,
+		INVALID_FLAG,
+		INVALID_OPTION,
+		AMBIGUOUS_OPTION,
+		MISSING_VALUE,
+		REPEATED_ARGUMENT,
+		MISSING_POSITIONAL,
+		INVALID_COMMAND,
+		INVALID_ENVIRONMENT,
+		RESPONSE_FILE_DEPTH,
+		CONVERSION,
+		INVALID_CHOICE,
+		OUT_OF_RANGE
+	};
+
+	/**
+	 * Outcome of a try_parse_args(), try_parse() or try_arg() call.
+	 *
+	 * A failed status records the error code and where the error occurred; the
+	 * message is only formatted when message() is called, so reporting a failure
+	 * costs no allocation. The status refers to the command-line strings and to
+	 * the definitions of the parser that produced it: call message() while they
+	 * are alive, and before the next parse with the same parser or result when
+	 * the failing argument was read from a response file.
+	 */
+	class Parse_Status {
+	public:
+
+		/** Value of argument() when the error does not concern a defined argument */
+		static constexpr std::size_t NPOS{static_cast<std::size_t>(-1)};
+
+		/**
+		 * Construct successful status.
+		 */
+		Parse_Status() noexcept = default;
+
+		/**
+		 * @return true if the call succeeded, or false otherwise
+		 */
+		bool ok() const noexcept {
+			return m_code == Parse_Errc::NONE;
+		}
+
+		/**
+		 * Equivalent to calling ok().
+		 */
+		explicit operator bool() const noexcept {
+			return ok();
+		}
+
+		/**
+		 * @return the error code
+		 */
+		Parse_Errc code() const noexcept {
+			return m_code;
+		}
+
+		/**
+		 * @return the index into argv of the offending command-line argument, or -1
+		 *         if the error does not concern a single argument (for example, a
+		 *         missing positional argument or an environment variable). For an
+		 *         argument read from a response file, this is the index of the
+		 *         '@path' argument.
+		 */
+		int arg_index() const noexcept {
+			return m_arg_index;
+		}
+
+		/**
+		 * @return the byte offset of the offending argument within the response
+		 *         file that it was read from (the innermost one, for nested files),
+		 *         or NPOS if it was not read from a response file
+		 */
+		std::size_t file_offset() const noexcept {
+			return m_file_offset;
+		}
+
+		/**
+		 * @return the definition index of the argument that the error concerns,
+		 *         among the optional arguments or (for MISSING_POSITIONAL) the
+		 *         positional arguments, or NPOS if there is none
+		 */
+		std::size_t argument() const noexcept {
+			return m_argument;
+		}
+
+		/**
+		 * @return the offending text: the unknown flag (without the dash when it is
+		 *         part of a cluster), option or command, the rejected value, or the
+		 *         environment variable name or response file path
+		 */
+		String_View token() const noexcept {
+			return m_token;
+		}
+
+		/**
+		 * Format the error message, as thrown by the corresponding throwing
+		 * function.
+		 *
+		 * @return the error message, or an empty string if the call succeeded
+		 */
+		std::string message() const {
+			switch (m_code) {
+			case Parse_Errc::NONE:
+				return std::string{};
+			case Parse_Errc::INVALID_FLAG:
+				if (!m_detail.empty())
+					return errstr(m_script_name, "invalid flag '-", m_token, "' in '", m_detail, "', pass --help to display possible options");
+				return errstr(m_script_name, "invalid flag '", m_token, "', pass --help to display possible options");
+			case Parse_Errc::INVALID_OPTION: {
+				const auto suggestion = m_names ? m_names->suggest(m_token) : String_View{};
+				if (!suggestion.empty())
+					return errstr(m_script_name, "invalid option '", m_token, "' (did you mean '--", suggestion, "'?), pass --help to display possible options");
+				return errstr(m_script_name, "invalid option '", m_token, "', pass --help to display possible options");
+			}
+			case Parse_Errc::AMBIGUOUS_OPTION: {
+				std::string matches;
+				const auto last = m_names->prefix_end(m_token);
+				for (auto entry = m_names->prefix_begin(m_token); entry != last; ++entry) {
+					if (!matches.empty())
+						matches += ", ";
+					matches.append("--").append(entry->name.data(), entry->name.size());
+				}
+				return errstr(m_script_name, "ambiguous option '", m_token, "' could match ", matches);
+			}
+			case Parse_Errc::MISSING_VALUE:
+				return errstr(m_script_name, "'", m_name, "' requires a value");
+			case Parse_Errc::REPEATED_ARGUMENT:
+				return errstr(m_script_name, "'", m_name, "' should only be specified once");
+			case Parse_Errc::MISSING_POSITIONAL:
+				return errstr(m_script_name, "requires positional argument '", m_name, "'");
+			case Parse_Errc::INVALID_COMMAND:
+				return errstr(m_script_name, "invalid command '", m_token, "', pass --help to display possible commands");
+			case Parse_Errc::INVALID_ENVIRONMENT:
+				return errstr(m_script_name, "environment variable '", m_token, "' for '", m_name, "' must be a boolean");
+			case Parse_Errc::RESPONSE_FILE_DEPTH:
+				return errstr(m_script_name, "response file '", m_token, "' is nested too deeply");
+			case Parse_Errc::CONVERSION:
+				return m_conversion_error(m_script_name, m_name, m_convert_error);
+			case Parse_Errc::INVALID_CHOICE:
+				return errstr(m_script_name, "invalid choice '", m_token, "' for '", m_name, "' (choose from ", m_detail, ")");
+			case Parse_Errc::OUT_OF_RANGE:
+				return errstr(m_script_name, "'", m_name, "' must be in range ", m_detail);
+			}
+			return std::string{};
+		}
+
+	private:
+		friend class Argument_Parser;
+		template<class> friend class Argument_Info;
+
+		using Conversion_Error = std::string (*)(String_View, String_View, Convert_Error);
+
+		Parse_Errc m_code{Parse_Errc::NONE};
+		int m_arg_index{-1};
+		std::size_t m_argument{NPOS};
+		std::size_t m_file_offset{NPOS};
+		String_View m_script_name;
+		String_View m_token;
+		String_View m_name;
+		String_View m_detail;
+		const Prefix_Index *m_names{nullptr};
+		Convert_Error m_convert_error{Convert_Error::NONE};
+		Conversion_Error m_conversion_error{nullptr};
+
+		Parse_Status(Parse_Errc code, String_View script_name, int arg_index) noexcept
+				: m_code{code},
+				  m_arg_index{arg_index},
+				  m_script_name{script_name} { }
+
+		/**
+		 * @return the status with the offending text set
+		 */
+		Parse_Status &with_token(String_View token) noexcept {
+			m_token = token;
+			return *this;
+		}
+
+		/**
+		 * @return the status with the offset within a response file set
+		 */
+		Parse_Status &with_file_offset(std::size_t offset) noexcept {
+			m_file_offset = offset;
+			return *this;
+		}
+
+		/**
+		 * @return the status with the argument that the error concerns set
+		 */
+		Parse_Status &with_argument(std::size_t argument, String_View name) noexcept {
+			m_argument = argument;
+			m_name = name;
+			return *this;
+		}
+
+		/**
+		 * @return the status with the allowed choices or range of the argument, or
+		 *         the cluster holding an invalid flag, set
+		 */
+		Parse_Status &with_detail(String_View detail) noexcept {
+			m_detail = detail;
+			return *this;
+		}
+
+		/**
+		 * @return the status with the option names used to format suggestions set
+		 */
+		Parse_Status &with_names(const Prefix_Index &names) noexcept {
+			m_names = &names;
+			return *this;
+		}
+
+		/**
+		 * @return the status with the conversion error set, to be formatted by the
+		 *         given conversion_error() instantiation
+		 */
+		Parse_Status &with_conversion(Convert_Error err, Conversion_Error format) noexcept {
+			m_convert_error = err;
+			m_conversion_error = format;
+			return *this;
+		}
+	};
+
+}
+
+#endif /* CPARSEPARSE_PARSE_STATUS_H_ */
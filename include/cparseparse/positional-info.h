@@ -22,11 +22,13 @@ namespace cpparse {
 		/**
 		 * Construct positional argument info.
 		 *
-		 * @param name  argument name
+		 * @param name   argument name
+		 * @param state  state filled by the owning parser's parse_args()
 		 */
 		template<class String>
-		explicit Positional_Info(String &&name) noexcept(noexcept(Argument_Info{std::forward<String>(name)}))
-				: Argument_Info{std::forward<String>(name)} { }
+		explicit Positional_Info(String &&name, const Parse_State &state) noexcept(noexcept(Argument_Info{std::forward<String>(name)}))
+				: Argument_Info{std::forward<String>(name)},
+				  m_state{&state} { }
 
 		/**
 		 * Retrieve the argument as a value of type @a T.
@@ -36,30 +38,51 @@ namespace cpparse {
 		 * @throw std::runtime_error  if the argument cannot be parsed as type @a T
 		 */
 		template<class T>
-		T as_type() const noexcept(noexcept(parse_as_type<T>(std::string{}))) {
-			return parse_as_type<T>(m_value);
+		T as_type() const {
+			return as_type<T>(m_state->positionals[m_index]);
 		}
 
 		/**
-		 * Print argument description.
+		 * Retrieve a typed handle to this argument.
 		 *
-		 * @param text_width  text width spacing
-		 * @param out         output stream
+		 * The handle can be passed to the Argument_Parser query functions in place of
+		 * the argument name to skip the name lookup.
+		 *
+		 * @tparam T  type that the argument value is retrieved as
+		 * @return the argument handle
 		 */
-		void print(std::size_t text_width, std::ostream &out = std::cout) const {
-			print_help(text_width, out);
+		template<class T>
+		Arg_Handle<T> handle() const noexcept {
+			return Arg_Handle<T>{Arg_Handle<T>::Kind::POSITIONAL, m_index};
 		}
 
 	private:
 		friend class Argument_Parser;
+		friend class Parse_Result;
 
-		std::string m_value;
+		const Parse_State *m_state;
+
+		/**
+		 * Retrieve the value in the parse state as a value of type @a T.
+		 */
+		template<class T>
+		T as_type(const Positional_State &state) const {
+			return cached_as_type<T>(*state.context, state.cache, &state.value, 1, 0);
+		}
+
+		/**
+		 * Retrieve the value in the parse state as a value of type @a T without
+		 * throwing.
+		 */
+		template<class T>
+		Parse_Status try_as_type(const Positional_State &state, T &out) const {
+			return try_cached_as_type<T>(*state.context, state.cache, &state.value, 1, 0, out);
+		}
 
 		/* Private functions for Argument_Parser */
 
-		template<class String>
-		void set_value(String &&value) noexcept(std::is_nothrow_assignable<decltype(m_value), String &&>::value) {
-			m_value = std::forward<String>(value);
+		void set_index(std::size_t index) noexcept {
+			m_index = index;
 		}
 
 	};
@@ -0,0 +1,571 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_STATIC_SCHEMA_H_
+#define CPARSEPARSE_STATIC_SCHEMA_H_
+
+#include "cparseparse/argument-info.h"
+#include "cparseparse/optional-info.h"
+#include "cparseparse/util/convert.h"
+#include "cparseparse/util/errstr.h"
+#include "cparseparse/util/lexer.h"
+#include "cparseparse/util/string-view.h"
+
+#if __cplusplus >= 202002L && defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+#define CPPARSE_HAS_STATIC_SCHEMA 1
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpparse {
+
+	/**
+	 * String literal that can be passed as a template argument.
+	 */
+	template<std::size_t N>
+	struct Fixed_String {
+		constexpr Fixed_String(const char (&str)[N]) noexcept {
+			for (std::size_t i = 0; i < N; ++i)
+				data[i] = str[i];
+		}
+
+		constexpr String_View view() const noexcept {
+			return String_View{data, N - 1};
+		}
+
+		char data[N]{};
+	};
+
+	/**
+	 * @return true if the name is a valid optional argument reference name
+	 *         (@p [a-zA-Z_][a-zA-Z0-9_-]+)
+	 */
+	constexpr bool _static_option_name(String_View name) noexcept {
+		if (name.size() < 2 || !lex_is_name_start(name[0]))
+			return false;
+		for (std::size_t i = 1; i < name.size(); ++i) {
+			if (!lex_is_name_char(name[i]))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @return true if the name is a valid positional argument name
+	 *         (@p [a-zA-Z0-9_][a-zA-Z0-9_-]*)
+	 */
+	constexpr bool _static_positional_name(String_View name) noexcept {
+		if (name.empty() || (!lex_is_name_start(name[0]) && !('0' <= name[0] && name[0] <= '9')))
+			return false;
+		for (std::size_t i = 1; i < name.size(); ++i) {
+			if (!lex_is_name_char(name[i]))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Optional argument of a Static_Schema.
+	 *
+	 * The result field is a @a bool for FLAG arguments, a @a std::optional<T> for
+	 * SINGLE arguments and a @a std::vector<T> for APPEND arguments.
+	 *
+	 * @tparam Name  reference name, without leading dashes
+	 * @tparam Flag  flag character, or @p '\0' for none
+	 * @tparam Type  optional argument type
+	 * @tparam T     type that the values are converted to
+	 */
+	template<Fixed_String Name, char Flag = '\0', Optional_Info::Type Type = Optional_Info::Type::SINGLE,
+			class T = std::conditional_t<Type == Optional_Info::Type::FLAG, bool, std::string>>
+	struct Static_Optional {
+		static_assert(_static_option_name(Name.view()), "invalid optional argument name");
+		static_assert(Flag == '\0' || lex_is_name_start(Flag), "invalid flag name");
+		static_assert(Type != Optional_Info::Type::FLAG || std::is_same<T, bool>::value, "flag arguments must have type bool");
+
+		static constexpr String_View name{Name.view()};
+		static constexpr char flag{Flag};
+		static constexpr Optional_Info::Type type{Type};
+		static constexpr bool positional{false};
+
+		using Value = T;
+		using Field = std::conditional_t<Type == Optional_Info::Type::FLAG, bool,
+				std::conditional_t<Type == Optional_Info::Type::APPEND, std::vector<T>, std::optional<T>>>;
+	};
+
+	/**
+	 * Positional argument of a Static_Schema. Positional arguments are required;
+	 * the result field is of type @a T.
+	 *
+	 * @tparam Name  argument name
+	 * @tparam T     type that the value is converted to
+	 */
+	template<Fixed_String Name, class T = std::string>
+	struct Static_Positional {
+		static_assert(_static_positional_name(Name.view()), "invalid positional argument name");
+
+		static constexpr String_View name{Name.view()};
+		static constexpr char flag{'\0'};
+		static constexpr Optional_Info::Type type{Optional_Info::Type::SINGLE};
+		static constexpr bool positional{true};
+
+		using Value = T;
+		using Field = T;
+	};
+
+	/**
+	 * @return the index of the name in the array, or the array size if it is not
+	 *         present
+	 */
+	template<std::size_t N>
+	constexpr std::size_t _static_name_index(const std::array<String_View, N> &names, String_View name) noexcept {
+		for (std::size_t i = 0; i < N; ++i) {
+			if (names[i] == name)
+				return i;
+		}
+		return N;
+	}
+
+	template<class ...Args>
+	class Static_Schema;
+
+	/**
+	 * Typed values parsed by a Static_Schema.
+	 *
+	 * String_View fields and the script name refer into the parsed argv strings.
+	 */
+	template<class ...Args>
+	class Static_Result {
+	public:
+
+		/**
+		 * @tparam Name  argument name
+		 * @return the field holding the values of the named argument
+		 */
+		template<Fixed_String Name>
+		auto &get() noexcept {
+			return std::get<field_index<Name>()>(m_fields);
+		}
+
+		template<Fixed_String Name>
+		const auto &get() const noexcept {
+			return std::get<field_index<Name>()>(m_fields);
+		}
+
+		/**
+		 * @return the script name (argv[0])
+		 */
+		String_View script_name() const noexcept {
+			return m_script_name;
+		}
+
+		/**
+		 * @return the positional arguments beyond those defined by the schema
+		 */
+		const std::vector<const char *> &extra_args() const noexcept {
+			return m_extra_args;
+		}
+
+	private:
+		friend class Static_Schema<Args...>;
+
+		std::tuple<typename Args::Field...> m_fields;
+		String_View m_script_name;
+		std::vector<const char *> m_extra_args;
+
+		template<Fixed_String Name>
+		static constexpr std::size_t field_index() noexcept {
+			constexpr auto idx = _static_name_index(std::array<String_View, sizeof...(Args)>{Args::name...}, Name.view());
+			static_assert(idx < sizeof...(Args), "no argument with the given name");
+			return idx;
+		}
+	};
+
+	/** Perfect hash parameters found by _static_find_hash() */
+	struct _Static_Hash {
+		std::uint64_t seed;
+		std::size_t size;
+	};
+
+	/**
+	 * Seeded 64-bit FNV-1a hash with a final avalanche, so that the low bits depend
+	 * on every character.
+	 */
+	constexpr std::uint64_t _static_hash(String_View name, std::uint64_t seed) noexcept {
+		std::uint64_t hash{14695981039346656037ull ^ (seed * 0x9e3779b97f4a7c15ull)};
+		for (const char c : name) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/**
+	 * @return true if the optional argument names hash to distinct slots of a
+	 *         table of the given size
+	 */
+	template<std::size_t N>
+	constexpr bool _static_hash_is_perfect(const std::array<String_View, N> &names, const std::array<bool, N> &positional,
+			std::uint64_t seed, std::size_t size) noexcept {
+		std::array<std::uint64_t, N> slots{};
+		for (std::size_t i = 0; i < N; ++i)
+			slots[i] = _static_hash(names[i], seed) & (size - 1);
+		for (std::size_t i = 0; i < N; ++i) {
+			for (std::size_t j = i + 1; j < N; ++j) {
+				if (!positional[i] && !positional[j] && slots[i] == slots[j])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Find a seed and power-of-two table size for which the optional argument
+	 * names hash without collisions, starting from a table twice the number of
+	 * names and doubling it whenever a batch of seeds fails.
+	 */
+	template<std::size_t N>
+	constexpr _Static_Hash _static_find_hash(const std::array<String_View, N> &names, const std::array<bool, N> &positional) noexcept {
+		std::size_t options{0};
+		for (const bool is_positional : positional)
+			options += !is_positional;
+		std::size_t size{1};
+		while (size < options * 2)
+			size *= 2;
+		for (;; size *= 2) {
+			for (std::uint64_t seed = 0; seed < 64; ++seed) {
+				if (_static_hash_is_perfect(names, positional, seed, size))
+					return _Static_Hash{seed, size};
+			}
+		}
+	}
+
+	/**
+	 * @return true if no two names are equal
+	 */
+	template<std::size_t N>
+	constexpr bool _static_unique_names(const std::array<String_View, N> &names) noexcept {
+		for (std::size_t i = 0; i < N; ++i) {
+			for (std::size_t j = i + 1; j < N; ++j) {
+				if (names[i] == names[j])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @return true if no flag is used twice
+	 */
+	template<std::size_t N>
+	constexpr bool _static_unique_flags(const std::array<char, N> &flags) noexcept {
+		for (std::size_t i = 0; i < N; ++i) {
+			for (std::size_t j = i + 1; j < N; ++j) {
+				if (flags[i] != '\0' && flags[i] == flags[j])
+					return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Command-line argument schema defined entirely at compile time.
+	 *
+	 * An alternative front end to Argument_Parser for programs whose arguments
+	 * are fixed: names are validated when the schema is instantiated, flags are
+	 * looked up in a constant table and long options through a perfect hash
+	 * generated at compile time, and values are converted directly into the typed
+	 * fields of a Static_Result. There is nothing to construct at startup.
+	 *
+	 * @code
+	 * using Schema = cpparse::Static_Schema<
+	 *     cpparse::Static_Optional<"verbose", 'v', cpparse::Optional_Info::Type::FLAG>,
+	 *     cpparse::Static_Optional<"jobs", 'j', cpparse::Optional_Info::Type::SINGLE, int>,
+	 *     cpparse::Static_Positional<"target">>;
+	 * const auto args = Schema::parse(argc, argv);
+	 * const int jobs = args.get<"jobs">().value_or(1);
+	 * @endcode
+	 *
+	 * Unlike Argument_Parser, no '-h/--help' flag is added implicitly.
+	 *
+	 * @tparam Args  Static_Optional and Static_Positional argument definitions
+	 */
+	template<class ...Args>
+	class Static_Schema {
+	public:
+
+		/** Result type filled by parse() */
+		using Result = Static_Result<Args...>;
+
+		/**
+		 * Parse the command-line arguments.
+		 *
+		 * @param argc  command-line argument count
+		 * @param argv  command-line argument strings
+		 * @return the parsed values
+		 * @throw std::runtime_error  If the arguments do not match the schema, or a
+		 *                            value cannot be converted to its argument type.
+		 */
+		static Result parse(int argc, const char *const *argv) {
+			Result result;
+			parse(argc, argv, result);
+			return result;
+		}
+
+		/**
+		 * Parse the command-line arguments into an existing result.
+		 *
+		 * @see parse()
+		 */
+		static void parse(int argc, const char *const *argv, Result &result) {
+			result.m_fields = decltype(result.m_fields){};
+			result.m_extra_args.clear();
+			const String_View script_name{argv[0]};
+			result.m_script_name = script_name;
+			std::size_t positional_count{0};
+			bool options_ended{false};
+			for (int i = 1; i < argc; ++i) {
+				const auto token = lex_token(argv[i]);
+				if (token.kind == Token_Kind::SEPARATOR && !options_ended) {
+					options_ended = true;
+					continue;
+				}
+				if (!options_ended && is_flag_cluster(token, argv[i])) {
+					i = store_cluster(result, script_name, argc, argv, i);
+					continue;
+				}
+				if (options_ended || !token.is_option()) {
+					if (positional_count < POSITIONAL_COUNT)
+						store_positional(result, script_name, POSITIONAL_INDEX[positional_count++], argv[i], std::index_sequence_for<Args...>{});
+					else
+						result.m_extra_args.push_back(argv[i]);
+					continue;
+				}
+				const auto idx = lookup_option(script_name, token, argv[i]);
+				const auto next_arg = i + 1 < argc ? argv[i + 1] : nullptr;
+				if (store_optional(result, script_name, idx, next_arg, false, std::index_sequence_for<Args...>{}))
+					++i;
+			}
+			if (positional_count < POSITIONAL_COUNT)
+				CPPARSE_THROW(std::runtime_error{errstr(script_name, "requires positional argument '", NAMES[POSITIONAL_INDEX[positional_count]], "'")});
+		}
+
+	private:
+
+		/** Table entry for an unused slot */
+		static constexpr std::uint16_t NPOS{UINT16_MAX};
+
+		static_assert(sizeof...(Args) < NPOS, "too many arguments");
+
+		static constexpr std::array<String_View, sizeof...(Args)> NAMES{Args::name...};
+		static constexpr std::array<bool, sizeof...(Args)> POSITIONAL{Args::positional...};
+		static constexpr std::array<char, sizeof...(Args)> FLAGS{Args::flag...};
+		static constexpr std::size_t POSITIONAL_COUNT{(std::size_t{Args::positional} + ... + 0)};
+
+		static_assert(_static_unique_names(NAMES), "duplicate argument name");
+		static_assert(_static_unique_flags(FLAGS), "duplicate flag name");
+
+		static constexpr std::array<std::size_t, POSITIONAL_COUNT> positional_index() noexcept {
+			std::array<std::size_t, POSITIONAL_COUNT> indexes{};
+			std::size_t count{0};
+			for (std::size_t i = 0; i < POSITIONAL.size(); ++i) {
+				if (POSITIONAL[i])
+					indexes[count++] = i;
+			}
+			return indexes;
+		}
+
+		static constexpr std::array<std::uint16_t, 128> flag_table() noexcept {
+			std::array<std::uint16_t, 128> table{};
+			table.fill(NPOS);
+			for (std::size_t i = 0; i < FLAGS.size(); ++i) {
+				if (FLAGS[i] != '\0')
+					table[static_cast<unsigned char>(FLAGS[i])] = static_cast<std::uint16_t>(i);
+			}
+			return table;
+		}
+
+		static constexpr _Static_Hash HASH{_static_find_hash(NAMES, POSITIONAL)};
+
+		static constexpr std::array<std::uint16_t, HASH.size> name_table() noexcept {
+			std::array<std::uint16_t, HASH.size> table{};
+			table.fill(NPOS);
+			for (std::size_t i = 0; i < NAMES.size(); ++i) {
+				if (!POSITIONAL[i])
+					table[_static_hash(NAMES[i], HASH.seed) & (HASH.size - 1)] = static_cast<std::uint16_t>(i);
+			}
+			return table;
+		}
+
+		static constexpr std::array<std::size_t, POSITIONAL_COUNT> POSITIONAL_INDEX{positional_index()};
+		static constexpr std::array<std::uint16_t, 128> FLAG_TABLE{flag_table()};
+		static constexpr std::array<std::uint16_t, HASH.size> NAME_TABLE{name_table()};
+
+		/**
+		 * @return the index of the flag argument, or NPOS if it is not defined
+		 */
+		static std::uint16_t find_flag(char flag) noexcept {
+			const auto c = static_cast<unsigned char>(flag);
+			return c < FLAG_TABLE.size() ? FLAG_TABLE[c] : NPOS;
+		}
+
+		/**
+		 * @return the index of the optional argument with the long name, or NPOS if
+		 *         it is not defined
+		 */
+		static std::uint16_t find_option(String_View name) noexcept {
+			const auto idx = NAME_TABLE[_static_hash(name, HASH.seed) & (HASH.size - 1)];
+			return idx != NPOS && NAMES[idx] == name ? idx : NPOS;
+		}
+
+		/**
+		 * Determine whether the lexed token is a cluster of short flags.
+		 *
+		 * @see lex_is_flag_cluster()
+		 */
+		static bool is_flag_cluster(const Lexed_Token &token, const char *arg) noexcept {
+			return lex_is_flag_cluster(token, arg, [](char flag) {
+				return find_flag(flag) != NPOS;
+			}, [](const Lexed_Token &option) {
+				return find_option(String_View{option.name, option.length}) != NPOS;
+			});
+		}
+
+		/**
+		 * Look up the optional argument referred to by the lexed flag or option
+		 * token.
+		 *
+		 * @return the argument index
+		 */
+		static std::size_t lookup_option(String_View script_name, const Lexed_Token &token, const char *option_name) {
+			if (token.kind == Token_Kind::FLAG) {
+				const auto idx = find_flag(token.name[0]);
+				if (idx == NPOS)
+					CPPARSE_THROW(std::runtime_error{errstr(script_name, "invalid flag '", option_name, "'")});
+				return idx;
+			}
+			const String_View name{token.name, token.length};
+			const auto idx = find_option(name);
+			if (idx == NPOS)
+				CPPARSE_THROW(std::runtime_error{errstr(script_name, "invalid option '", name, "'")});
+			return idx;
+		}
+
+		/**
+		 * Store the short flags of a cluster, one character at a time.
+		 *
+		 * The first argument that takes a value ends the cluster: the rest of the
+		 * token is its value, or the next command-line argument if the token ends
+		 * there.
+		 *
+		 * @param i  index of the command-line argument holding the cluster
+		 * @return the index of the last command-line argument consumed
+		 */
+		static int store_cluster(Result &result, String_View script_name, int argc, const char *const *argv, int i) {
+			const char *const cluster{argv[i]};
+			for (auto it = cluster + 1; *it != '\0'; ++it) {
+				const auto idx = find_flag(*it);
+				if (idx == NPOS)
+					CPPARSE_THROW(std::runtime_error{errstr(script_name, "invalid flag '-", String_View{it, 1}, "' in '", cluster, "'")});
+				if (it[1] != '\0') {
+					if (store_optional(result, script_name, idx, it + 1, true, std::index_sequence_for<Args...>{}))
+						return i;
+					continue;
+				}
+				const auto next_arg = i + 1 < argc ? argv[i + 1] : nullptr;
+				if (store_optional(result, script_name, idx, next_arg, false, std::index_sequence_for<Args...>{}))
+					++i;
+			}
+			return i;
+		}
+
+		/**
+		 * Convert the value to type @a T.
+		 */
+		template<class T>
+		static T convert(String_View script_name, String_View name, String_View value) {
+			auto out = _convert_target<T>();
+			const auto err = convert_value<T>(value, out);
+			if (err != Convert_Error::NONE)
+				CPPARSE_THROW(std::runtime_error{conversion_error<T>(script_name, name, err)});
+			return out;
+		}
+
+		/**
+		 * Store the value of the positional argument at index @a idx.
+		 */
+		template<std::size_t ...Is>
+		static void store_positional(Result &result, String_View script_name, std::size_t idx, const char *value, std::index_sequence<Is...>) {
+			static_cast<void>(((Is == idx && (store_positional_at<Is>(result, script_name, value), true)) || ...));
+		}
+
+		template<std::size_t I>
+		static void store_positional_at(Result &result, String_View script_name, const char *value) {
+			using Arg = std::tuple_element_t<I, std::tuple<Args...>>;
+			if constexpr (Arg::positional)
+				std::get<I>(result.m_fields) = convert<typename Arg::Value>(script_name, Arg::name, value);
+		}
+
+		/**
+		 * Store an occurrence of the optional argument at index @a idx.
+		 *
+		 * @a next_arg is null when the option is the last command-line argument.
+		 *
+		 * @param attached  true if @a next_arg is the rest of a flag cluster, which
+		 *                  is taken as the value even if it looks like an option
+		 * @return true if @a next_arg was consumed as the option value
+		 */
+		template<std::size_t ...Is>
+		static bool store_optional(Result &result, String_View script_name, std::size_t idx, const char *next_arg, bool attached, std::index_sequence<Is...>) {
+			bool consumed{false};
+			static_cast<void>(((Is == idx && (consumed = store_optional_at<Is>(result, script_name, next_arg, attached), true)) || ...));
+			return consumed;
+		}
+
+		template<std::size_t I>
+		static bool store_optional_at(Result &result, String_View script_name, const char *next_arg, bool attached) {
+			using Arg = std::tuple_element_t<I, std::tuple<Args...>>;
+			if constexpr (Arg::positional) {
+				return false;
+			} else {
+				auto &field = std::get<I>(result.m_fields);
+				if constexpr (Arg::type == Optional_Info::Type::FLAG) {
+					if (field)
+						CPPARSE_THROW(std::runtime_error{errstr(script_name, "'", Arg::name, "' should only be specified once")});
+					field = true;
+					return false;
+				} else {
+					if (!attached && (next_arg == nullptr || lex_token(next_arg).is_option()))
+						CPPARSE_THROW(std::runtime_error{errstr(script_name, "'", Arg::name, "' requires a value")});
+					if constexpr (Arg::type == Optional_Info::Type::APPEND) {
+						field.push_back(convert<typename Arg::Value>(script_name, Arg::name, next_arg));
+					} else {
+						if (field)
+							CPPARSE_THROW(std::runtime_error{errstr(script_name, "'", Arg::name, "' should only be specified once")});
+						field = convert<typename Arg::Value>(script_name, Arg::name, next_arg);
+					}
+					return true;
+				}
+			}
+		}
+
+	};
+
+}
+
+#endif /* __cplusplus >= 202002L && defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L */
+
+#endif /* CPARSEPARSE_STATIC_SCHEMA_H_ */
@@ -7,6 +7,8 @@
 #ifndef CPARSEPARSE_UTIL_COMPAT_H_
 #define CPARSEPARSE_UTIL_COMPAT_H_
 
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
 
 namespace cpparse {
@@ -27,6 +29,47 @@ namespace cpparse {
 #else
 #define IF_CONSTEXPR if
 #endif /* __cplusplus >= 201703L */
+
+/*
+ * Linkage of the out-of-line library functions: inline in header-only builds,
+ * or external when they are compiled once into libcparseparse.a.
+ */
+#ifdef CPPARSE_COMPILED_LIB
+#define CPPARSE_INLINE
+#else
+#define CPPARSE_INLINE inline
+#endif /* CPPARSE_COMPILED_LIB */
+
+/*
+ * Exception macros, so that the library builds with exceptions disabled
+ * (-fno-exceptions). Without exceptions, CPPARSE_THROW prints the message of the
+ * exception object and aborts; the try_*() functions report parse errors
+ * through Parse_Status instead.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CPPARSE_EXCEPTIONS 1
+#define CPPARSE_THROW(...) throw __VA_ARGS__
+#define CPPARSE_TRY try
+#define CPPARSE_CATCH(declaration) catch (declaration)
+#define CPPARSE_CATCH_ALL catch (...)
+#define CPPARSE_RETHROW throw
+#else
+#define CPPARSE_THROW(...) ::cpparse::_fatal_error(__VA_ARGS__)
+#define CPPARSE_TRY if (true)
+#define CPPARSE_CATCH(declaration) else if (false)
+#define CPPARSE_CATCH_ALL else
+#define CPPARSE_RETHROW static_cast<void>(0)
+#endif /* defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND) */
+
+	/**
+	 * Report an error that would have been thrown, and abort.
+	 */
+	template<class Exception>
+	[[noreturn]] void _fatal_error(const Exception &exception) noexcept {
+		std::fputs(exception.what(), stderr);
+		std::fputc('\n', stderr);
+		std::abort();
+	}
 }
 
 #endif /* CPARSEPARSE_UTIL_COMPAT_H_ */
@@ -0,0 +1,104 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_CONFIG_LEXER_H_
+#define CPARSEPARSE_UTIL_CONFIG_LEXER_H_
+
+#include "cparseparse/util/string-view.h"
+
+namespace cpparse {
+
+	/**
+	 * Configuration file line classification.
+	 *
+	 * BLANK    empty line, or a comment starting with @p '#' or @p ';'.
+	 *
+	 * SECTION  @p [name] header; @a name may be empty.
+	 *
+	 * ENTRY    @p key=value assignment, or a bare @p key.
+	 *
+	 * INVALID  anything else.
+	 */
+	enum class Config_Line_Kind { BLANK, SECTION, ENTRY, INVALID };
+
+	/**
+	 * Classified configuration file line.
+	 *
+	 * For SECTION lines, @a name is the section name. For ENTRY lines, @a name is
+	 * the key and @a value is the raw text following the @p '=' (pass it to
+	 * config_value() to trim and unquote it); @a has_value is false for a bare key.
+	 */
+	struct Config_Line {
+		Config_Line_Kind kind;
+		String_View name;
+		String_View value;
+		bool has_value;
+	};
+
+	inline bool _config_is_space(char c) noexcept {
+		return c == ' ' || ('\t' <= c && c <= '\r');
+	}
+
+	/**
+	 * @return the view with leading and trailing whitespace removed
+	 */
+	inline String_View config_trim(String_View str) noexcept {
+		auto first = str.data();
+		auto last = first + str.size();
+		while (first != last && _config_is_space(*first))
+			++first;
+		while (last != first && _config_is_space(last[-1]))
+			--last;
+		return String_View{first, static_cast<std::size_t>(last - first)};
+	}
+
+	/**
+	 * Classify a configuration file line.
+	 *
+	 * Only the key is examined; the value is left untouched, so that entries that
+	 * are going to be ignored cost no more than a scan for the @p '='.
+	 *
+	 * @param line  line contents, without the line terminator
+	 * @return the classified line
+	 */
+	inline Config_Line lex_config_line(String_View line) noexcept {
+		const auto trimmed = config_trim(line);
+		if (trimmed.empty() || trimmed[0] == '#' || trimmed[0] == ';')
+			return Config_Line{Config_Line_Kind::BLANK, String_View{}, String_View{}, false};
+		if (trimmed[0] == '[') {
+			if (trimmed[trimmed.size() - 1] != ']')
+				return Config_Line{Config_Line_Kind::INVALID, String_View{}, String_View{}, false};
+			const auto name = config_trim(String_View{trimmed.data() + 1, trimmed.size() - 2});
+			return Config_Line{Config_Line_Kind::SECTION, name, String_View{}, false};
+		}
+
+		const auto first = trimmed.data();
+		const auto last = first + trimmed.size();
+		auto eq = first;
+		while (eq != last && *eq != '=')
+			++eq;
+		const auto key = config_trim(String_View{first, static_cast<std::size_t>(eq - first)});
+		if (key.empty())
+			return Config_Line{Config_Line_Kind::INVALID, String_View{}, String_View{}, false};
+		if (eq == last)
+			return Config_Line{Config_Line_Kind::ENTRY, key, String_View{}, false};
+		return Config_Line{Config_Line_Kind::ENTRY, key, String_View{eq + 1, static_cast<std::size_t>(last - eq - 1)}, true};
+	}
+
+	/**
+	 * Trim the raw entry value, removing one pair of matching single or double
+	 * quotes around it.
+	 */
+	inline String_View config_value(String_View value) noexcept {
+		value = config_trim(value);
+		if (value.size() >= 2 && (value[0] == '"' || value[0] == '\'') && value[value.size() - 1] == value[0])
+			return String_View{value.data() + 1, value.size() - 2};
+		return value;
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_CONFIG_LEXER_H_ */
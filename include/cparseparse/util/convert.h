@@ -0,0 +1,369 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_CONVERT_H_
+#define CPARSEPARSE_UTIL_CONVERT_H_
+
+#include "cparseparse/util/string-view.h"
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#define CPPARSE_HAS_FROM_CHARS 1
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define CPPARSE_HAS_FLOAT_FROM_CHARS 1
+#endif /* defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L */
+#endif /* __has_include(<charconv>) */
+#endif /* __cplusplus >= 201703L && defined(__has_include) */
+
+namespace cpparse {
+
+	/**
+	 * Result of a value conversion.
+	 *
+	 * NONE          the conversion succeeded.
+	 *
+	 * INVALID       the value does not have the expected format.
+	 *
+	 * OUT_OF_RANGE  the value is well-formed but cannot be represented by the
+	 *               target type.
+	 */
+	enum class Convert_Error { NONE, INVALID, OUT_OF_RANGE };
+
+	/**
+	 * Conversion of argument values to a user-defined type @a T.
+	 *
+	 * Specialize for a type (or, through @a Enable, a family of types) to make it
+	 * available to as_type(), arg(), on_value() and the other typed queries. A
+	 * specialization provides
+	 *
+	 *     static Convert_Error convert(String_View value, T &out);
+	 *
+	 * which converts the value in place, assigning @a out only on success, and may
+	 * provide
+	 *
+	 *     static std::string error(String_View name, Convert_Error err);
+	 *
+	 * which describes a failed conversion of the named argument, such as
+	 * "'timeout' must be a duration". The converter is selected at compile time
+	 * and reads the value directly from the command-line string. Specializations
+	 * for the built-in types (arithmetic types, std::string and String_View) are
+	 * not used.
+	 *
+	 * Because @a out is assigned rather than constructed, @a T must be
+	 * default-constructible (and move-constructible, to be cached). Values are
+	 * only kept for the conversions that succeed.
+	 */
+	template<class T, class Enable = void>
+	struct converter { };
+
+	/**
+	 * @return a default-constructed value of type @a T for a conversion to assign
+	 */
+	template<class T>
+	T _convert_target() {
+		static_assert(std::is_default_constructible<T>::value, "argument values can only be converted to default-constructible types; see cpparse::converter");
+		return T{};
+	}
+
+	/**
+	 * Helpers for selecting a converter specialization.
+	 */
+	template<class T>
+	struct _convert_is_builtin : std::integral_constant<bool, std::is_arithmetic<T>::value
+			|| std::is_same<T, std::string>::value || std::is_same<T, String_View>::value> { };
+
+	template<class T, class = void>
+	struct _convert_has_converter : std::false_type { };
+	template<class T>
+	struct _convert_has_converter<T, decltype(static_cast<void>(converter<T>::convert(std::declval<String_View>(), std::declval<T &>())))>
+			: std::integral_constant<bool, !_convert_is_builtin<T>::value> { };
+
+	template<class T, class = void>
+	struct _convert_has_error : std::false_type { };
+	template<class T>
+	struct _convert_has_error<T, decltype(static_cast<void>(converter<T>::error(std::declval<String_View>(), Convert_Error::NONE)))>
+			: _convert_has_converter<T> { };
+
+	/**
+	 * Helpers for convert_value().
+	 */
+	inline bool _convert_is_digit(char c) noexcept {
+		return '0' <= c && c <= '9';
+	}
+
+	inline bool _convert_is_space(char c) noexcept {
+		return c == ' ' || ('\t' <= c && c <= '\r');
+	}
+
+	/**
+	 * Skip leading whitespace and an optional '+' sign without accepting a second
+	 * sign, matching the prefix accepted by std::stoll()/std::stold().
+	 */
+	inline Convert_Error _convert_skip_prefix(const char *&first, const char *last) noexcept {
+		while (first != last && _convert_is_space(*first))
+			++first;
+		if (first != last && *first == '+') {
+			++first;
+			if (first != last && (*first == '-' || *first == '+'))
+				return Convert_Error::INVALID;
+		}
+		return Convert_Error::NONE;
+	}
+
+	template<class T>
+	Convert_Error _convert_integer(const char *first, const char *last, T &out) noexcept {
+#ifdef CPPARSE_HAS_FROM_CHARS
+		const auto result = std::from_chars(first, last, out);
+		if (result.ec == std::errc::invalid_argument)
+			return Convert_Error::INVALID;
+		if (result.ec == std::errc::result_out_of_range)
+			return Convert_Error::OUT_OF_RANGE;
+		return Convert_Error::NONE;
+#else
+		using Unsigned = typename std::make_unsigned<T>::type;
+		const bool negative = first != last && *first == '-';
+		if (negative)
+			++first;
+		if (first == last || !_convert_is_digit(*first))
+			return Convert_Error::INVALID;
+
+		const Unsigned max = static_cast<Unsigned>(std::numeric_limits<T>::max());
+		const Unsigned limit = negative ? max + 1 : max;
+		Unsigned acc = 0;
+		for (; first != last && _convert_is_digit(*first); ++first) {
+			const Unsigned digit = *first - '0';
+			if (acc > (limit - digit) / 10)
+				return Convert_Error::OUT_OF_RANGE;
+			acc = acc * 10 + digit;
+		}
+		if (!negative)
+			out = static_cast<T>(acc);
+		else if (acc == limit)
+			out = std::numeric_limits<T>::lowest();
+		else
+			out = -static_cast<T>(acc);
+		return Convert_Error::NONE;
+#endif /* CPPARSE_HAS_FROM_CHARS */
+	}
+
+#ifndef CPPARSE_HAS_FLOAT_FROM_CHARS
+	/**
+	 * Advance past the word if the string starts with it, ignoring case.
+	 *
+	 * @param word  lowercase word
+	 */
+	inline bool _convert_skip_word(const char *&first, const char *last, const char *word) noexcept {
+		auto it = first;
+		for (; *word != '\0'; ++word, ++it) {
+			if (it == last || (*it | 0x20) != *word)
+				return false;
+		}
+		first = it;
+		return true;
+	}
+
+	/**
+	 * Find the end of the longest prefix that std::from_chars() accepts as a
+	 * floating-point value in the general format: an optional '-' followed by a
+	 * decimal number with an optional exponent, or by inf, infinity, nan or
+	 * nan(chars) in any case. Unlike strtold(), hexadecimal numbers and the '.' of
+	 * other locales are not accepted.
+	 *
+	 * @return the end of the prefix, or @a first if there is none
+	 */
+	inline const char *_convert_floating_end(const char *first, const char *last) noexcept {
+		const auto skip_digits = [last](const char *it) {
+			while (it != last && _convert_is_digit(*it))
+				++it;
+			return it;
+		};
+		auto it = first;
+		if (it != last && *it == '-')
+			++it;
+		if (_convert_skip_word(it, last, "inf")) {
+			_convert_skip_word(it, last, "inity");
+			return it;
+		}
+		if (_convert_skip_word(it, last, "nan")) {
+			if (it != last && *it == '(') {
+				auto close = it + 1;
+				while (close != last && (_convert_is_digit(*close) || ('a' <= (*close | 0x20) && (*close | 0x20) <= 'z') || *close == '_'))
+					++close;
+				if (close != last && *close == ')')
+					it = close + 1;
+			}
+			return it;
+		}
+		const auto integer = it;
+		it = skip_digits(it);
+		bool any_digits = it != integer;
+		if (it != last && *it == '.') {
+			const auto fraction = it + 1;
+			const auto fraction_end = skip_digits(fraction);
+			if (any_digits || fraction_end != fraction) {
+				any_digits = true;
+				it = fraction_end;
+			}
+		}
+		if (!any_digits)
+			return first;
+		if (it != last && (*it == 'e' || *it == 'E')) {
+			auto exponent = it + 1;
+			if (exponent != last && (*exponent == '-' || *exponent == '+'))
+				++exponent;
+			const auto exponent_end = skip_digits(exponent);
+			if (exponent_end != exponent)
+				it = exponent_end;
+		}
+		return it;
+	}
+#endif /* CPPARSE_HAS_FLOAT_FROM_CHARS */
+
+	template<class T>
+	Convert_Error _convert_floating(const char *first, const char *last, T &out) noexcept {
+#ifdef CPPARSE_HAS_FLOAT_FROM_CHARS
+		const auto result = std::from_chars(first, last, out);
+		if (result.ec == std::errc::invalid_argument)
+			return Convert_Error::INVALID;
+		if (result.ec == std::errc::result_out_of_range)
+			return Convert_Error::OUT_OF_RANGE;
+#else
+		/*
+		 * Validate the value with the grammar of std::from_chars(), then pass the
+		 * valid prefix to strtold() null-terminated and with '.' replaced by the
+		 * decimal point of the current locale
+		 */
+		last = _convert_floating_end(first, last);
+		if (last == first)
+			return Convert_Error::INVALID;
+		const char *point = std::localeconv()->decimal_point;
+		const std::size_t point_size = std::strlen(point);
+		char buffer[64];
+		std::unique_ptr<char[]> heap_buffer;
+		const std::size_t size = last - first;
+		char *str = buffer;
+		if (size + point_size >= sizeof(buffer)) {
+			heap_buffer.reset(new (std::nothrow) char[size + point_size + 1]);
+			if (!heap_buffer)
+				return Convert_Error::INVALID;
+			str = heap_buffer.get();
+		}
+		const auto dot = static_cast<const char *>(std::memchr(first, '.', size));
+		if (dot) {
+			const std::size_t before = dot - first;
+			std::memcpy(str, first, before);
+			std::memcpy(str + before, point, point_size);
+			std::memcpy(str + before + point_size, dot + 1, size - before - 1);
+			str[size - 1 + point_size] = '\0';
+		} else {
+			std::memcpy(str, first, size);
+			str[size] = '\0';
+		}
+
+		char *end;
+		errno = 0;
+		const auto value = std::strtold(str, &end);
+		if (end == str)
+			return Convert_Error::INVALID;
+		if (errno == ERANGE)
+			return Convert_Error::OUT_OF_RANGE;
+		if (value < std::numeric_limits<T>::lowest() || value > std::numeric_limits<T>::max())
+			return Convert_Error::OUT_OF_RANGE;
+		out = static_cast<T>(value);
+#endif /* CPPARSE_HAS_FLOAT_FROM_CHARS */
+		if (out < std::numeric_limits<T>::lowest() || out > std::numeric_limits<T>::max())
+			return Convert_Error::OUT_OF_RANGE;
+		return Convert_Error::NONE;
+	}
+
+	/**
+	 * Convert the string value to type @a T without throwing.
+	 *
+	 * Numeric conversions accept leading whitespace, an optional sign and the
+	 * longest valid numeric prefix, and use std::from_chars() when available.
+	 * Floating-point conversions accept the grammar of std::from_chars() in every
+	 * language standard and locale: decimal numbers with a '.' point, inf and nan,
+	 * but not hexadecimal numbers. Unsigned conversions reject a leading '-' as out
+	 * of range rather than wrapping.
+	 * Other types are converted by their converter specialization.
+	 *
+	 * @tparam T     target type
+	 * @param value  string value
+	 * @param out    converted value; only assigned on success
+	 * @return the conversion result
+	 */
+	template<class T>
+	typename std::enable_if<std::is_same<T, bool>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept {
+		if (value == "true" || value == "yes" || value == "on")
+			out = true;
+		else if (value == "false" || value == "no" || value == "off")
+			out = false;
+		else
+			return Convert_Error::INVALID;
+		return Convert_Error::NONE;
+	}
+	template<class T>
+	typename std::enable_if<std::is_same<T, char>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept {
+		if (value.size() != 1)
+			return Convert_Error::INVALID;
+		out = value[0];
+		return Convert_Error::NONE;
+	}
+	template<class T>
+	typename std::enable_if<!std::is_same<T, bool>::value && std::is_integral<T>::value && std::is_unsigned<T>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept {
+		const char *first = value.data(), *last = first + value.size();
+		const auto err = _convert_skip_prefix(first, last);
+		if (err != Convert_Error::NONE)
+			return err;
+		if (first != last && *first == '-')
+			return Convert_Error::OUT_OF_RANGE;
+		return _convert_integer(first, last, out);
+	}
+	template<class T>
+	typename std::enable_if<!std::is_same<T, char>::value && std::is_integral<T>::value && std::is_signed<T>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept {
+		const char *first = value.data(), *last = first + value.size();
+		const auto err = _convert_skip_prefix(first, last);
+		if (err != Convert_Error::NONE)
+			return err;
+		return _convert_integer(first, last, out);
+	}
+	template<class T>
+	typename std::enable_if<std::is_floating_point<T>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept {
+		const char *first = value.data(), *last = first + value.size();
+		const auto err = _convert_skip_prefix(first, last);
+		if (err != Convert_Error::NONE)
+			return err;
+		return _convert_floating(first, last, out);
+	}
+	template<class T>
+	typename std::enable_if<std::is_same<T, std::string>::value, Convert_Error>::type convert_value(String_View value, T &out) {
+		out.assign(value.data(), value.size());
+		return Convert_Error::NONE;
+	}
+	template<class T>
+	typename std::enable_if<std::is_same<T, String_View>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept {
+		out = value;
+		return Convert_Error::NONE;
+	}
+	template<class T>
+	typename std::enable_if<_convert_has_converter<T>::value, Convert_Error>::type convert_value(String_View value, T &out) noexcept(noexcept(converter<T>::convert(value, out))) {
+		return converter<T>::convert(value, out);
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_CONVERT_H_ */
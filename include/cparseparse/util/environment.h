@@ -0,0 +1,60 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_ENVIRONMENT_H_
+#define CPARSEPARSE_UTIL_ENVIRONMENT_H_
+
+#include "cparseparse/util/string-view.h"
+#include <cstring>
+
+#if defined(__APPLE__)
+#include <crt_externs.h>
+#elif defined(_WIN32)
+#include <cstdlib>
+#else
+extern "C" char **environ;
+#endif /* defined(__APPLE__) */
+
+namespace cpparse {
+
+	/**
+	 * @return the process environment block: a null-terminated array of
+	 *         @p NAME=value strings
+	 */
+	inline const char *const *environment_block() noexcept {
+#if defined(__APPLE__)
+		return *_NSGetEnviron();
+#elif defined(_WIN32)
+		return _environ;
+#else
+		return environ;
+#endif /* defined(__APPLE__) */
+	}
+
+	/**
+	 * Call the function with the name and value of each environment variable, in
+	 * a single pass over the environment block.
+	 *
+	 * The views refer into the environment block and are only valid until the
+	 * environment is modified. Entries without an @p '=' are skipped.
+	 *
+	 * @param function  callable taking the variable name and value as String_View
+	 */
+	template<class Function>
+	void for_each_env(Function &&function) {
+		const auto block = environment_block();
+		if (!block)
+			return;
+		for (auto entry = block; *entry; ++entry) {
+			const auto eq = std::strchr(*entry, '=');
+			if (eq)
+				function(String_View{*entry, static_cast<std::size_t>(eq - *entry)}, String_View{eq + 1});
+		}
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_ENVIRONMENT_H_ */
@@ -7,32 +7,39 @@
 #ifndef CPARSEPARSE_UTIL_ERRSTR_H_
 #define CPARSEPARSE_UTIL_ERRSTR_H_
 
-#include <sstream>
+#include "cparseparse/util/compat.h"
+#include "cparseparse/util/string-view.h"
+#include <cstdio>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 namespace cpparse {
 
-	std::string _scriptname;
-
 	/**
-	 * Set script name for error print-outs.
+	 * Helpers for errstr()/lerrstr(), appending each word to the string.
 	 */
-	template<class String_Ref>
-	void errstr_set_script_name(String_Ref &&name) {
-		_scriptname = std::forward<String_Ref>(name);
+	inline void _errstr(std::string &out, String_View arg) {
+		out.append(arg.data(), arg.size());
 	}
-
-	/**
-	 * Recursive helpers for errstr()/lerrstr().
-	 */
-	template<class Arg>
-	void _errstr(std::stringstream &ss, Arg &&arg) {
-		ss << std::forward<Arg>(arg);
+	inline void _errstr(std::string &out, char arg) {
+		out.push_back(arg);
+	}
+	template<class T>
+	typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value && !std::is_same<T, bool>::value>::type
+	_errstr(std::string &out, T arg) {
+		out.append(std::to_string(arg));
+	}
+	template<class T>
+	typename std::enable_if<std::is_floating_point<T>::value>::type _errstr(std::string &out, T arg) {
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(arg));
+		out.append(buffer);
 	}
-	template<class Arg, class ...Args>
-	void _errstr(std::stringstream &ss, Arg &&arg, Args&&... args) {
-		_errstr(ss, std::forward<Arg>(arg));
-		_errstr(ss, std::forward<Args>(args)...);
+	template<class Arg, class Next, class ...Args>
+	void _errstr(std::string &out, Arg &&arg, Next &&next, Args&&... args) {
+		_errstr(out, std::forward<Arg>(arg));
+		_errstr(out, std::forward<Next>(next), std::forward<Args>(args)...);
 	}
 
 	/**
@@ -40,19 +47,19 @@ namespace cpparse {
 	 */
 	template<class ...Args>
 	std::string lerrstr(Args&&... args) {
-		std::stringstream ss;
-		_errstr(ss, "Argument_Parser: ", std::forward<Args>(args)...);
-		return ss.str();
+		std::string out;
+		_errstr(out, "Argument_Parser: ", std::forward<Args>(args)...);
+		return out;
 	}
 
 	/**
-	 * Concatenate words into a runtime error string.
+	 * Concatenate words into a runtime error string prefixed by the script name.
 	 */
 	template<class ...Args>
-	std::string errstr(Args&&... args) {
-		std::stringstream ss;
-		_errstr(ss, _scriptname, ": ", std::forward<Args>(args)...);
-		return ss.str();
+	std::string errstr(String_View script_name, Args&&... args) {
+		std::string out;
+		_errstr(out, script_name, ": ", std::forward<Args>(args)...);
+		return out;
 	}
 
 }
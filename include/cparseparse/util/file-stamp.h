@@ -0,0 +1,75 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_FILE_STAMP_H_
+#define CPARSEPARSE_UTIL_FILE_STAMP_H_
+
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define CPPARSE_HAS_FILE_STAMP 1
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+namespace cpparse {
+
+	/**
+	 * Identity and modification time of a file, used to tell whether it may have
+	 * changed since it was last read.
+	 *
+	 * Where the file status cannot be queried, every stamp is invalid and compares
+	 * unequal, so the file is always treated as changed.
+	 */
+	struct File_Stamp {
+
+		/**
+		 * Query the stamp of the file at the given path.
+		 *
+		 * @param path  file path
+		 * @return the file stamp; invalid if the file does not exist
+		 */
+		static File_Stamp of(const char *path) noexcept {
+			File_Stamp stamp;
+#ifdef CPPARSE_HAS_FILE_STAMP
+			struct stat st;
+			if (::stat(path, &st) != 0)
+				return stamp;
+			stamp.device = static_cast<std::uint64_t>(st.st_dev);
+			stamp.inode = static_cast<std::uint64_t>(st.st_ino);
+			stamp.size = static_cast<std::uint64_t>(st.st_size);
+			stamp.mtime_sec = static_cast<std::int64_t>(st.st_mtime);
+#if defined(__APPLE__)
+			stamp.mtime_nsec = static_cast<std::int64_t>(st.st_mtimespec.tv_nsec);
+#else
+			stamp.mtime_nsec = static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+#endif /* defined(__APPLE__) */
+			stamp.valid = true;
+#else
+			static_cast<void>(path);
+#endif /* CPPARSE_HAS_FILE_STAMP */
+			return stamp;
+		}
+
+		bool operator==(const File_Stamp &other) const noexcept {
+			return valid && other.valid && device == other.device && inode == other.inode
+					&& size == other.size && mtime_sec == other.mtime_sec && mtime_nsec == other.mtime_nsec;
+		}
+
+		bool operator!=(const File_Stamp &other) const noexcept {
+			return !(*this == other);
+		}
+
+		std::uint64_t device{0};
+		std::uint64_t inode{0};
+		std::uint64_t size{0};
+		std::int64_t mtime_sec{0};
+		std::int64_t mtime_nsec{0};
+		bool valid{false};
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_FILE_STAMP_H_ */
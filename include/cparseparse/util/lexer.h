@@ -0,0 +1,171 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_LEXER_H_
+#define CPARSEPARSE_UTIL_LEXER_H_
+
+#include "cparseparse/util/string-view.h"
+#include <cstddef>
+
+namespace cpparse {
+
+	/**
+	 * Command-line token classification.
+	 *
+	 * POSITIONAL  anything that is not an option; either a positional argument or
+	 *             the value of a preceding option.
+	 *
+	 * FLAG        short flag: @p '-' followed by a single name character.
+	 *
+	 * OPTION      long option: @p '-' or @p '--' followed by a name that is at
+	 *             least two characters long.
+	 *
+	 * SEPARATOR   the bare @p '--' token.
+	 *
+	 * CLUSTER     @p '-' followed by a flag name character and further characters
+	 *             that do not form a long option name, such as @p -ofile.txt; a
+	 *             cluster of short flags, the last of which may take the rest of
+	 *             the token as its value. Clusters that do form a long option name,
+	 *             such as @p -vvv, are lexed as OPTION and left to the parser to
+	 *             tell apart.
+	 */
+	enum class Token_Kind { POSITIONAL, FLAG, OPTION, SEPARATOR, CLUSTER };
+
+	/**
+	 * Classified command-line token.
+	 *
+	 * For FLAG, OPTION and CLUSTER tokens, @a name points into the original
+	 * argument just past the leading dashes. It is not null-terminated at @a length;
+	 * CLUSTER tokens run to the end of the argument.
+	 */
+	struct Lexed_Token {
+		Token_Kind kind;
+		const char *name;
+		std::size_t length;
+
+		/**
+		 * @return true if the token is a flag or long option, or false otherwise
+		 */
+		bool is_option() const noexcept {
+			return kind == Token_Kind::FLAG || kind == Token_Kind::OPTION;
+		}
+	};
+
+	/**
+	 * @return true if the character can start an option name ([a-zA-Z_])
+	 */
+	constexpr bool lex_is_name_start(char c) noexcept {
+		return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_';
+	}
+
+	/**
+	 * @return true if the character can continue an option name ([a-zA-Z0-9_-])
+	 */
+	constexpr bool lex_is_name_char(char c) noexcept {
+		return lex_is_name_start(c) || ('0' <= c && c <= '9') || c == '-';
+	}
+
+	/**
+	 * Classify a command-line argument in a single pass.
+	 *
+	 * @param arg     argument string
+	 * @param at_end  callable taking a pointer into @a arg, returning true if it
+	 *                points at the end of the argument
+	 */
+	template<class At_End>
+	Lexed_Token _lex_token(const char *arg, const At_End &at_end) noexcept {
+		const Lexed_Token positional{Token_Kind::POSITIONAL, arg, 0};
+		if (at_end(arg) || arg[0] != '-')
+			return positional;
+
+		const char *name = arg + 1;
+		if (at_end(name))
+			return positional;
+		if (name[0] == '-') {
+			if (at_end(name + 1))
+				return Lexed_Token{Token_Kind::SEPARATOR, name + 1, 0};
+			++name;
+		} else if (lex_is_name_start(name[0]) && at_end(name + 1)) {
+			return Lexed_Token{Token_Kind::FLAG, name, 1};
+		}
+
+		if (!lex_is_name_start(name[0]))
+			return positional;
+		const char *it = name + 1;
+		while (!at_end(it) && lex_is_name_char(*it))
+			++it;
+		if (!at_end(it) || it - name < 2) {
+			if (name != arg + 1)
+				return positional;
+			while (!at_end(it))
+				++it;
+			return Lexed_Token{Token_Kind::CLUSTER, name, static_cast<std::size_t>(it - name)};
+		}
+		return Lexed_Token{Token_Kind::OPTION, name, static_cast<std::size_t>(it - name)};
+	}
+
+	/**
+	 * Classify a null-terminated command-line argument in a single pass.
+	 *
+	 * Flags match @p -[a-zA-Z_], long options match
+	 * @p --?[a-zA-Z_][a-zA-Z0-9_-]+ and any other @p -[a-zA-Z_].+ is a cluster.
+	 *
+	 * @param arg  null-terminated argument string
+	 * @return the classified token
+	 */
+	inline Lexed_Token lex_token(const char *arg) noexcept {
+		return _lex_token(arg, [](const char *it) { return *it == '\0'; });
+	}
+
+	/**
+	 * Classify a command-line argument that need not be null-terminated, as for
+	 * lex_token(const char *).
+	 *
+	 * @param arg  argument string
+	 * @return the classified token
+	 */
+	inline Lexed_Token lex_token(String_View arg) noexcept {
+		const auto last = arg.data() + arg.size();
+		return _lex_token(arg.data(), [last](const char *it) { return it == last; });
+	}
+
+	/**
+	 * Determine whether the lexed token is a cluster of short flags, such as
+	 * @p -vvv, @p -xzf or @p -j8: a CLUSTER token, or a single-dash OPTION token
+	 * that does not name a long option, whose first character is a defined flag.
+	 *
+	 * @param token           lexed token
+	 * @param arg             argument that @a token was lexed from
+	 * @param is_flag         callable taking a flag character, returning true if
+	 *                        the flag is defined
+	 * @param is_long_option  callable taking the OPTION token, returning true if
+	 *                        it names a long option
+	 */
+	template<class Is_Flag, class Is_Long_Option>
+	bool lex_is_flag_cluster(const Lexed_Token &token, const char *arg, const Is_Flag &is_flag, const Is_Long_Option &is_long_option) {
+		if (token.kind != Token_Kind::CLUSTER && (token.kind != Token_Kind::OPTION || arg[1] == '-'))
+			return false;
+		if (!is_flag(token.name[0]))
+			return false;
+		return token.kind == Token_Kind::CLUSTER || !is_long_option(token);
+	}
+
+	/**
+	 * Check whether the null-terminated string is a valid positional argument name
+	 * (@p [a-zA-Z0-9_][a-zA-Z0-9_-]*).
+	 */
+	inline bool lex_positional_name(const char *name) noexcept {
+		if (!lex_is_name_start(name[0]) && !('0' <= name[0] && name[0] <= '9'))
+			return false;
+		const char *it = name + 1;
+		while (lex_is_name_char(*it))
+			++it;
+		return *it == '\0';
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_LEXER_H_ */
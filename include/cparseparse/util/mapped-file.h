@@ -0,0 +1,159 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_MAPPED_FILE_H_
+#define CPARSEPARSE_UTIL_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CPPARSE_HAS_MMAP 1
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+namespace cpparse {
+
+	/**
+	 * Read-only view of a file's contents.
+	 *
+	 * The file is memory-mapped shared and read-only where supported, so that its
+	 * pages are loaded on demand from the page cache and never copied; otherwise,
+	 * it is read into a heap buffer. The contents are not null-terminated.
+	 */
+	class Mapped_File {
+	public:
+
+		/**
+		 * Map the file at the given path.
+		 *
+		 * Check the result with the boolean conversion; the file is not mapped if it
+		 * could not be opened or is not a regular file.
+		 *
+		 * @param path  null-terminated file path
+		 */
+		explicit Mapped_File(const char *path) noexcept {
+#ifdef CPPARSE_HAS_MMAP
+			const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				return;
+			struct stat st;
+			if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+				map(fd, static_cast<std::size_t>(st.st_size));
+			::close(fd);
+#else
+			read(path);
+#endif /* CPPARSE_HAS_MMAP */
+		}
+
+		Mapped_File(Mapped_File &&other) noexcept
+				: m_data{other.m_data},
+				  m_size{other.m_size},
+				  m_valid{other.m_valid} {
+			other.m_data = nullptr;
+			other.m_valid = false;
+		}
+
+		Mapped_File &operator=(Mapped_File &&other) noexcept {
+			if (this != &other) {
+				release();
+				m_data = other.m_data;
+				m_size = other.m_size;
+				m_valid = other.m_valid;
+				other.m_data = nullptr;
+				other.m_valid = false;
+			}
+			return *this;
+		}
+
+		~Mapped_File() {
+			release();
+		}
+
+		/* Disable copy operations */
+		Mapped_File(const Mapped_File &) = delete;
+		Mapped_File &operator=(const Mapped_File &) = delete;
+
+		/**
+		 * @return true if the file was mapped, or false otherwise
+		 */
+		explicit operator bool() const noexcept {
+			return m_valid;
+		}
+
+		/**
+		 * @return the file contents; null for an empty file
+		 */
+		const char *data() const noexcept {
+			return m_data;
+		}
+
+		/**
+		 * @return the file size in bytes
+		 */
+		std::size_t size() const noexcept {
+			return m_size;
+		}
+
+	private:
+		char *m_data{nullptr};
+		std::size_t m_size{0};
+		bool m_valid{false};
+
+#ifdef CPPARSE_HAS_MMAP
+		void map(int fd, std::size_t size) noexcept {
+			if (size == 0) {
+				m_valid = true;
+				return;
+			}
+			const auto region = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+			if (region == MAP_FAILED)
+				return;
+			m_data = static_cast<char *>(region);
+			m_size = size;
+			m_valid = true;
+		}
+
+		void release() noexcept {
+			if (m_data)
+				::munmap(m_data, m_size);
+			m_data = nullptr;
+		}
+#else
+		void read(const char *path) noexcept {
+			const auto file = std::fopen(path, "rb");
+			if (!file)
+				return;
+			if (std::fseek(file, 0, SEEK_END) == 0) {
+				const auto size = std::ftell(file);
+				if (size >= 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+					m_data = new (std::nothrow) char[size > 0 ? size : 1];
+					if (m_data && std::fread(m_data, 1, size, file) == static_cast<std::size_t>(size)) {
+						m_size = size;
+						m_valid = true;
+					} else {
+						release();
+					}
+				}
+			}
+			std::fclose(file);
+		}
+
+		void release() noexcept {
+			delete[] m_data;
+			m_data = nullptr;
+		}
+#endif /* CPPARSE_HAS_MMAP */
+
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_MAPPED_FILE_H_ */
@@ -0,0 +1,157 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_MEMORY_H_
+#define CPARSEPARSE_UTIL_MEMORY_H_
+
+#include "cparseparse/util/compat.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define CPPARSE_HAS_PMR 1
+#endif /* __has_include(<memory_resource>) */
+#endif /* __cplusplus >= 201703L && defined(__has_include) */
+
+namespace cpparse {
+
+#ifdef CPPARSE_HAS_PMR
+	using Memory_Resource = std::pmr::memory_resource;
+#else
+	/** Placeholder; memory resources require C++17 */
+	class Memory_Resource;
+#endif /* CPPARSE_HAS_PMR */
+
+	/**
+	 * Allocator that draws memory from a Memory_Resource.
+	 *
+	 * Unlike std::pmr::polymorphic_allocator, the resource propagates on container
+	 * copy, move and swap, so that containers of non-movable elements remain
+	 * move-assignable. A null resource selects the default resource; without C++17
+	 * memory resource support, memory is always taken from the global heap.
+	 *
+	 * @tparam T  allocated type
+	 */
+	template<class T>
+	class Resource_Allocator {
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		/**
+		 * Construct allocator.
+		 *
+		 * @param resource  memory resource; must outlive all memory allocated from it
+		 */
+		Resource_Allocator(Memory_Resource *resource = nullptr) noexcept
+#ifdef CPPARSE_HAS_PMR
+				: m_resource{resource ? resource : std::pmr::get_default_resource()} { }
+#else
+				: m_resource{resource} { }
+#endif /* CPPARSE_HAS_PMR */
+
+		template<class U>
+		Resource_Allocator(const Resource_Allocator<U> &other) noexcept
+				: m_resource{other.resource()} { }
+
+		/**
+		 * @return the memory resource, or null for the global heap
+		 */
+		Memory_Resource *resource() const noexcept {
+			return m_resource;
+		}
+
+		T *allocate(std::size_t count) {
+#ifdef CPPARSE_HAS_PMR
+			return static_cast<T *>(m_resource->allocate(count * sizeof(T), alignof(T)));
+#else
+			return static_cast<T *>(::operator new(count * sizeof(T)));
+#endif /* CPPARSE_HAS_PMR */
+		}
+
+		void deallocate(T *ptr, std::size_t count) noexcept {
+#ifdef CPPARSE_HAS_PMR
+			m_resource->deallocate(ptr, count * sizeof(T), alignof(T));
+#else
+			static_cast<void>(count);
+			::operator delete(ptr);
+#endif /* CPPARSE_HAS_PMR */
+		}
+
+	private:
+		Memory_Resource *m_resource;
+	};
+
+	template<class T, class U>
+	bool operator==(const Resource_Allocator<T> &lhs, const Resource_Allocator<U> &rhs) noexcept {
+#ifdef CPPARSE_HAS_PMR
+		return lhs.resource() == rhs.resource() || lhs.resource()->is_equal(*rhs.resource());
+#else
+		return lhs.resource() == rhs.resource();
+#endif /* CPPARSE_HAS_PMR */
+	}
+
+	template<class T, class U>
+	bool operator!=(const Resource_Allocator<T> &lhs, const Resource_Allocator<U> &rhs) noexcept {
+		return !(lhs == rhs);
+	}
+
+	/** Vector that allocates from a Memory_Resource */
+	template<class T>
+	using Resource_Vector = std::vector<T, Resource_Allocator<T>>;
+
+	/**
+	 * Deleter for objects created with make_resource_unique().
+	 */
+	template<class T>
+	class Resource_Deleter {
+	public:
+		Resource_Deleter(Memory_Resource *resource = nullptr) noexcept
+				: m_allocator{resource} { }
+
+		void operator()(T *ptr) noexcept {
+			ptr->~T();
+			m_allocator.deallocate(ptr, 1);
+		}
+
+	private:
+		Resource_Allocator<T> m_allocator;
+	};
+
+	/** Unique pointer to an object allocated from a Memory_Resource */
+	template<class T>
+	using Resource_Ptr = std::unique_ptr<T, Resource_Deleter<T>>;
+
+	/**
+	 * Construct an object of type @a T in memory allocated from the resource.
+	 *
+	 * @param resource  memory resource; must outlive the object
+	 * @param args      constructor arguments
+	 * @return the owning pointer
+	 */
+	template<class T, class ...Args>
+	Resource_Ptr<T> make_resource_unique(Memory_Resource *resource, Args&&... args) {
+		Resource_Allocator<T> allocator{resource};
+		const auto ptr = allocator.allocate(1);
+		CPPARSE_TRY {
+			::new (static_cast<void *>(ptr)) T(std::forward<Args>(args)...);
+		} CPPARSE_CATCH_ALL {
+			allocator.deallocate(ptr, 1);
+			CPPARSE_RETHROW;
+		}
+		return Resource_Ptr<T>{ptr, Resource_Deleter<T>{resource}};
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_MEMORY_H_ */
@@ -0,0 +1,136 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_NAME_INDEX_H_
+#define CPARSEPARSE_UTIL_NAME_INDEX_H_
+
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/string-view.h"
+#include <cstdint>
+
+namespace cpparse {
+
+	/**
+	 * Compute the 64-bit FNV-1a hash of the string.
+	 */
+	inline std::uint64_t hash_name(String_View name) noexcept {
+		std::uint64_t hash{14695981039346656037ull};
+		for (const auto c : name) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	/**
+	 * Compact open-addressing map from names to integer values.
+	 *
+	 * Slots are stored contiguously and probed linearly. The index does not own the
+	 * names; each inserted name must stay valid (and at the same address) for the
+	 * lifetime of the index.
+	 */
+	class Name_Index {
+	public:
+
+		/** Value returned from find() when the name is not present */
+		static constexpr std::uint32_t NPOS{UINT32_MAX};
+
+		/**
+		 * Construct name index.
+		 *
+		 * @param resource  memory resource that the slots are allocated from
+		 */
+		explicit Name_Index(Memory_Resource *resource = nullptr) noexcept
+				: m_slots(Resource_Allocator<Slot>{resource}) { }
+
+		/**
+		 * @return the number of names in the index
+		 */
+		std::size_t size() const noexcept {
+			return m_size;
+		}
+
+		/**
+		 * Look up the value stored for the name.
+		 *
+		 * @param name  name to look up
+		 * @return the stored value, or NPOS if the name is not present
+		 */
+		std::uint32_t find(String_View name) const noexcept {
+			return find(name, hash_name(name));
+		}
+
+		/**
+		 * Look up the value stored for the name with a precomputed hash.
+		 *
+		 * @param name  name to look up
+		 * @param hash  hash_name() of @a name
+		 * @return the stored value, or NPOS if the name is not present
+		 */
+		std::uint32_t find(String_View name, std::uint64_t hash) const noexcept {
+			if (m_slots.empty())
+				return NPOS;
+			const auto mask = m_slots.size() - 1;
+			for (auto i = static_cast<std::size_t>(hash) & mask; ; i = (i + 1) & mask) {
+				const auto &slot = m_slots[i];
+				if (slot.value == NPOS)
+					return NPOS;
+				if (slot.hash == hash && slot.name == name)
+					return slot.value;
+			}
+		}
+
+		/**
+		 * Insert the name with the given value.
+		 *
+		 * @param name   name to insert; must outlive the index
+		 * @param value  value to associate with the name (must not be NPOS)
+		 * @return true if the name was inserted, or false if it was already present
+		 */
+		bool insert(String_View name, std::uint32_t value) {
+			const auto hash = hash_name(name);
+			if (find(name, hash) != NPOS)
+				return false;
+			if ((m_size + 1) * 2 > m_slots.size())
+				rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+			place(Slot{name, hash, value});
+			++m_size;
+			return true;
+		}
+
+	private:
+
+		struct Slot {
+			String_View name;
+			std::uint64_t hash;
+			std::uint32_t value;
+		};
+
+		Resource_Vector<Slot> m_slots;
+		std::size_t m_size{0};
+
+		void place(const Slot &slot) noexcept {
+			const auto mask = m_slots.size() - 1;
+			auto i = static_cast<std::size_t>(slot.hash) & mask;
+			while (m_slots[i].value != NPOS)
+				i = (i + 1) & mask;
+			m_slots[i] = slot;
+		}
+
+		void rehash(std::size_t capacity) {
+			Resource_Vector<Slot> slots(capacity, Slot{String_View{}, 0, NPOS}, m_slots.get_allocator());
+			slots.swap(m_slots);
+			for (const auto &slot : slots) {
+				if (slot.value != NPOS)
+					place(slot);
+			}
+		}
+
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_NAME_INDEX_H_ */
@@ -0,0 +1,181 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_PREFIX_INDEX_H_
+#define CPARSEPARSE_UTIL_PREFIX_INDEX_H_
+
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/string-ops.h"
+#include "cparseparse/util/string-view.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace cpparse {
+
+	/**
+	 * Sorted array of names searchable by prefix.
+	 *
+	 * The names sharing a prefix are adjacent, so both a unique prefix match and
+	 * the list of all matches are found with one binary search. The index does not
+	 * own the names; each inserted name must stay valid (and at the same address)
+	 * for the lifetime of the index.
+	 *
+	 * Names are appended unsorted and sorted once by the first lookup after an
+	 * insertion, so that building an index of n names takes O(n log n) time.
+	 * Concurrent lookups are safe; insert() must not race with them.
+	 */
+	class Prefix_Index {
+	public:
+
+		/** Value returned from find_prefix() when the prefix matches no name */
+		static constexpr std::uint32_t NPOS{UINT32_MAX};
+
+		/** Value returned from find_prefix() when the prefix matches several names */
+		static constexpr std::uint32_t AMBIGUOUS{UINT32_MAX - 1};
+
+		struct Entry {
+			String_View name;
+			std::uint32_t value;
+		};
+
+		using const_iterator = Resource_Vector<Entry>::const_iterator;
+
+		/**
+		 * Construct prefix index.
+		 *
+		 * @param resource  memory resource that the entries are allocated from
+		 */
+		explicit Prefix_Index(Memory_Resource *resource = nullptr) noexcept
+				: m_entries(Resource_Allocator<Entry>{resource}) { }
+
+		/* Disable copy and move operations */
+		Prefix_Index(const Prefix_Index &) = delete;
+		Prefix_Index &operator=(const Prefix_Index &) = delete;
+
+		/**
+		 * Insert the name with the given value.
+		 *
+		 * @param name   name to insert; must outlive the index and differ from the
+		 *               names already inserted
+		 * @param value  value to associate with the name
+		 */
+		void insert(String_View name, std::uint32_t value) {
+			m_entries.push_back(Entry{name, value});
+			m_order.store(UNSORTED, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Look up the only name that starts with the prefix.
+		 *
+		 * @param prefix  name prefix
+		 * @return the value stored for the matching name, NPOS if no name matches,
+		 *         or AMBIGUOUS if more than one name matches
+		 */
+		std::uint32_t find_prefix(String_View prefix) const noexcept {
+			const auto first = lower_bound(prefix);
+			if (first == m_entries.end() || !starts_with(first->name, prefix))
+				return NPOS;
+			const auto next = first + 1;
+			if (next != m_entries.end() && starts_with(next->name, prefix))
+				return AMBIGUOUS;
+			return first->value;
+		}
+
+		/**
+		 * @return the first of the entries whose names start with the prefix, in
+		 *         sorted order
+		 */
+		const_iterator prefix_begin(String_View prefix) const noexcept {
+			return lower_bound(prefix);
+		}
+
+		/**
+		 * @return the end of the entries whose names start with the prefix
+		 */
+		const_iterator prefix_end(String_View prefix) const noexcept {
+			const auto &entries = sorted();
+			return std::partition_point(entries.begin(), entries.end(), [prefix](const Entry &entry) {
+				return entry.name < prefix || starts_with(entry.name, prefix);
+			});
+		}
+
+		/**
+		 * Find the name that an unknown name most likely meant: the only name that it
+		 * is a prefix of, or else the closest name within a small edit distance.
+		 *
+		 * @return the suggested name, or an empty view if there is none
+		 */
+		String_View suggest(String_View name) const {
+			const auto first = lower_bound(name);
+			if (first != m_entries.end() && starts_with(first->name, name)) {
+				const auto next = first + 1;
+				if (next == m_entries.end() || !starts_with(next->name, name))
+					return first->name;
+			}
+			String_View best;
+			auto best_distance = std::max<std::size_t>(1, name.size() / 3) + 1;
+			for (const auto &entry : m_entries) {
+				const auto length_difference = entry.name.size() > name.size() ? entry.name.size() - name.size() : name.size() - entry.name.size();
+				if (length_difference >= best_distance)
+					continue;
+				const auto distance = edit_distance(name, entry.name);
+				if (distance < best_distance) {
+					best = entry.name;
+					best_distance = distance;
+				}
+			}
+			return best;
+		}
+
+		const_iterator begin() const noexcept {
+			return sorted().begin();
+		}
+
+		const_iterator end() const noexcept {
+			return sorted().end();
+		}
+
+	private:
+		enum : unsigned char { SORTED, UNSORTED, SORTING };
+
+		mutable Resource_Vector<Entry> m_entries;
+		mutable std::atomic<unsigned char> m_order{SORTED};
+
+		/**
+		 * @return the entries, after sorting them if names were inserted since the
+		 *         last lookup
+		 */
+		const Resource_Vector<Entry> &sorted() const noexcept {
+			auto order = m_order.load(std::memory_order_acquire);
+			if (order == SORTED)
+				return m_entries;
+			/* The first reader sorts the entries; any others wait for it to finish */
+			if (order == UNSORTED && m_order.compare_exchange_strong(order, SORTING, std::memory_order_acquire)) {
+				std::sort(m_entries.begin(), m_entries.end(), [](const Entry &lhs, const Entry &rhs) {
+					return lhs.name < rhs.name;
+				});
+				m_order.store(SORTED, std::memory_order_release);
+				return m_entries;
+			}
+			/* Yield while waiting so that the sorting thread is not starved of a core */
+			while (m_order.load(std::memory_order_acquire) != SORTED)
+				std::this_thread::yield();
+			return m_entries;
+		}
+
+		const_iterator lower_bound(String_View name) const noexcept {
+			const auto &entries = sorted();
+			return std::lower_bound(entries.begin(), entries.end(), name, [](const Entry &entry, String_View key) {
+				return entry.name < key;
+			});
+		}
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_PREFIX_INDEX_H_ */
@@ -0,0 +1,99 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_RESPONSE_FILE_H_
+#define CPARSEPARSE_UTIL_RESPONSE_FILE_H_
+
+#include "cparseparse/util/string-view.h"
+#include <cstddef>
+
+namespace cpparse {
+
+	/**
+	 * @return true if the argument names a response file (@p @path)
+	 */
+	inline bool is_response_file_arg(String_View arg) noexcept {
+		return arg.size() > 1 && arg[0] == '@';
+	}
+
+	inline bool _response_is_space(char c) noexcept {
+		return c == ' ' || ('\t' <= c && c <= '\r');
+	}
+
+	/**
+	 * Scan one argument of response file contents, passing each of its unescaped
+	 * characters to @a put.
+	 *
+	 * @return the end of the argument's text
+	 */
+	template<class Put>
+	const char *_response_scan(const char *in, const char *last, Put &&put) {
+		char quote = 0;
+		for (; in != last; ++in) {
+			const char c = *in;
+			if (c == '\\' && in + 1 != last) {
+				put(*++in);
+			} else if (quote) {
+				if (c == quote)
+					quote = 0;
+				else
+					put(c);
+			} else if (c == '\'' || c == '"') {
+				quote = c;
+			} else if (_response_is_space(c)) {
+				break;
+			} else {
+				put(c);
+			}
+		}
+		return in;
+	}
+
+	/**
+	 * Split response file contents into arguments without modifying them.
+	 *
+	 * Follows the gcc/clang rules: arguments are separated by whitespace, single
+	 * or double quotes group characters (including whitespace) into an argument,
+	 * and a backslash escapes the following character.
+	 *
+	 * @a on_token is invoked with the text of each argument as it appears in the
+	 * contents, and the size of the argument once unescaped. If the sizes are
+	 * equal, the text is the argument itself; otherwise, unescape_response_arg()
+	 * produces it.
+	 *
+	 * @param first     start of the contents
+	 * @param last      end of the contents
+	 * @param on_token  callable taking a String_View and a std::size_t
+	 */
+	template<class Callback>
+	void tokenize_response_file(const char *first, const char *last, Callback &&on_token) {
+		const char *in = first;
+		for (;;) {
+			while (in != last && _response_is_space(*in))
+				++in;
+			if (in == last)
+				return;
+
+			const char *const token = in;
+			std::size_t size{0};
+			in = _response_scan(in, last, [&size](char) { ++size; });
+			on_token(String_View{token, static_cast<std::size_t>(in - token)}, size);
+		}
+	}
+
+	/**
+	 * Unescape the text of a response file argument.
+	 *
+	 * @param text  argument text passed to the tokenize_response_file() callback
+	 * @param out   destination, with room for the argument's unescaped size
+	 */
+	inline void unescape_response_arg(String_View text, char *out) {
+		_response_scan(text.data(), text.data() + text.size(), [&out](char c) { *out++ = c; });
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_RESPONSE_FILE_H_ */
@@ -0,0 +1,117 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_SNAPSHOT_H_
+#define CPARSEPARSE_UTIL_SNAPSHOT_H_
+
+#include "cparseparse/util/errstr.h"
+#include "cparseparse/util/string-view.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace cpparse {
+
+	/** Parse snapshot header magic number ('CPPS' in little-endian order) */
+	constexpr std::uint32_t SNAPSHOT_MAGIC{0x53505043u};
+
+	/** Parse snapshot format version */
+	constexpr std::uint32_t SNAPSHOT_VERSION{1};
+
+	/**
+	 * Appender of parse snapshot fields.
+	 *
+	 * Integers are written in host byte order and strings as a 32-bit length
+	 * followed by the characters and a null terminator, so that a loaded snapshot
+	 * can hand out C strings pointing into its buffer.
+	 */
+	class Snapshot_Writer {
+	public:
+		explicit Snapshot_Writer(std::vector<char> &out) noexcept
+				: m_out{&out} { }
+
+		void write_u32(std::uint32_t value) {
+			write_raw(&value, sizeof(value));
+		}
+
+		void write_u64(std::uint64_t value) {
+			write_raw(&value, sizeof(value));
+		}
+
+		void write_string(String_View str) {
+			write_u32(static_cast<std::uint32_t>(str.size()));
+			write_raw(str.data(), str.size());
+			m_out->push_back('\0');
+		}
+
+	private:
+		std::vector<char> *m_out;
+
+		void write_raw(const void *data, std::size_t size) {
+			const auto bytes = static_cast<const char *>(data);
+			m_out->insert(m_out->end(), bytes, bytes + size);
+		}
+	};
+
+	/**
+	 * Bounds-checked reader of parse snapshot fields.
+	 *
+	 * Strings are returned as views into the snapshot buffer without copying.
+	 */
+	class Snapshot_Reader {
+	public:
+		Snapshot_Reader(const char *data, std::size_t size) noexcept
+				: m_pos{data},
+				  m_end{data + size} { }
+
+		std::uint32_t read_u32() {
+			std::uint32_t value;
+			read_raw(&value, sizeof(value));
+			return value;
+		}
+
+		std::uint64_t read_u64() {
+			std::uint64_t value;
+			read_raw(&value, sizeof(value));
+			return value;
+		}
+
+		String_View read_string() {
+			const std::size_t size = read_u32();
+			if (static_cast<std::size_t>(m_end - m_pos) <= size || m_pos[size] != '\0')
+				throw_invalid();
+			const String_View str{m_pos, size};
+			m_pos += size + 1;
+			return str;
+		}
+
+		/**
+		 * @return true if the whole snapshot has been read, or false otherwise
+		 */
+		bool at_end() const noexcept {
+			return m_pos == m_end;
+		}
+
+		[[noreturn]] static void throw_invalid() {
+			CPPARSE_THROW(std::runtime_error{lerrstr("invalid parse snapshot")});
+		}
+
+	private:
+		const char *m_pos;
+		const char *m_end;
+
+		void read_raw(void *value, std::size_t size) {
+			if (static_cast<std::size_t>(m_end - m_pos) < size)
+				throw_invalid();
+			std::memcpy(value, m_pos, size);
+			m_pos += size;
+		}
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_SNAPSHOT_H_ */
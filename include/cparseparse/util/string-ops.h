@@ -7,28 +7,132 @@
 #ifndef CPARSEPARSE_UTIL_STRING_OPS_H_
 #define CPARSEPARSE_UTIL_STRING_OPS_H_
 
+#include "cparseparse/util/string-view.h"
 #include <algorithm>
-#include <stdexcept>
+#include <cctype>
+#include <cstring>
 #include <string>
+#include <vector>
 
 namespace cpparse {
 
 	/**
- 	 * std::stoull overload to prevent unsigned integer wrap-around.
+	 * Append the string converted to uppercase characters.
 	 */
-	inline unsigned long long stoull(const std::string &value) {
-		if (value.find('-') != std::string::npos)
-			throw std::out_of_range{""};
-		return std::stoull(value);
+	inline void append_upper(std::string &out, String_View str) {
+		const auto first = out.size();
+		out.append(str.data(), str.size());
+		for (auto i = first; i < out.size(); ++i)
+			out[i] = static_cast<char>(toupper(static_cast<unsigned char>(out[i])));
 	}
 
 	/**
-	 * Convert string to all uppercase characters.
+	 * Append text that starts at the given column, word-wrapped so that no line
+	 * extends past @a width columns where possible.
+	 *
+	 * Continuation lines are indented to @a column. Words are separated by spaces
+	 * and a newline in the text starts a new line; a word longer than the space
+	 * available is placed on a line of its own rather than broken.
+	 *
+	 * @param out     string to append to, ending at @a column of its last line
+	 * @param text    text to append
+	 * @param column  column that the text starts at
+	 * @param width   line width, or 0 to append the text unwrapped
 	 */
-	inline std::string str_to_upper(const std::string &str) {
-		std::string rtn;
-		std::transform(str.begin(), str.end(), std::back_inserter(rtn), toupper);
-		return rtn;
+	inline void append_wrapped(std::string &out, String_View text, std::size_t column, std::size_t width) {
+		if (width <= column) {
+			out.append(text.data(), text.size());
+			return;
+		}
+		const auto available = width - column;
+		std::size_t line{0};
+		auto first = text.data();
+		const auto last = first + text.size();
+		while (first != last) {
+			if (*first == ' ') {
+				++first;
+				continue;
+			}
+			if (*first == '\n') {
+				out.push_back('\n');
+				out.append(column, ' ');
+				line = 0;
+				++first;
+				continue;
+			}
+			auto word_end = first;
+			while (word_end != last && *word_end != ' ' && *word_end != '\n')
+				++word_end;
+			const auto word = static_cast<std::size_t>(word_end - first);
+			if (line != 0 && line + 1 + word > available) {
+				out.push_back('\n');
+				out.append(column, ' ');
+				line = 0;
+			} else if (line != 0) {
+				out.push_back(' ');
+				++line;
+			}
+			out.append(first, word);
+			line += word;
+			first = word_end;
+		}
+	}
+
+	/**
+	 * @return true if the string begins with the prefix, or false otherwise
+	 */
+	inline bool starts_with(String_View str, String_View prefix) noexcept {
+		return str.size() >= prefix.size() && std::memcmp(str.data(), prefix.data(), prefix.size()) == 0;
+	}
+
+	/**
+	 * Compute the Levenshtein distance between two strings.
+	 */
+	inline std::size_t edit_distance(String_View lhs, String_View rhs) {
+		std::vector<std::size_t> row(rhs.size() + 1);
+		for (std::size_t j = 0; j < row.size(); ++j)
+			row[j] = j;
+		for (std::size_t i = 0; i < lhs.size(); ++i) {
+			auto diagonal = row[0];
+			row[0] = i + 1;
+			for (std::size_t j = 0; j < rhs.size(); ++j) {
+				const auto above = row[j + 1];
+				row[j + 1] = std::min(std::min(above, row[j]) + 1, diagonal + (lhs[i] == rhs[j] ? 0 : 1));
+				diagonal = above;
+			}
+		}
+		return row.back();
+	}
+
+	/**
+	 * Call the function with each field of the string separated by the delimiter,
+	 * in order.
+	 *
+	 * Delimiters are located with memchr(), which standard libraries vectorize, so
+	 * long lists are split at close to memory bandwidth. Adjacent and trailing
+	 * delimiters produce empty fields.
+	 *
+	 * @param str       string to split
+	 * @param delim     field delimiter
+	 * @param function  callable taking each field as a String_View
+	 */
+	template<class Function>
+	void split_fields(String_View str, char delim, Function &&function) {
+		if (str.empty()) {
+			function(str);
+			return;
+		}
+		auto first = str.data();
+		const auto last = first + str.size();
+		for (;;) {
+			const auto next = static_cast<const char *>(std::memchr(first, delim, static_cast<std::size_t>(last - first)));
+			if (!next) {
+				function(String_View{first, static_cast<std::size_t>(last - first)});
+				return;
+			}
+			function(String_View{first, static_cast<std::size_t>(next - first)});
+			first = next + 1;
+		}
 	}
 
 }
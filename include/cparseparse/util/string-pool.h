@@ -0,0 +1,164 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_STRING_POOL_H_
+#define CPARSEPARSE_UTIL_STRING_POOL_H_
+
+#include "cparseparse/util/memory.h"
+#include "cparseparse/util/string-view.h"
+#include <cstring>
+
+namespace cpparse {
+
+	/**
+	 * Append-only string storage.
+	 *
+	 * Strings are copied into blocks so that interning many short values costs only
+	 * an occasional allocation. Blocks start small and double in size, so that pools
+	 * holding only a few values stay compact. Views returned from intern() stay valid until
+	 * the pool is cleared or destroyed, and are always null-terminated.
+	 */
+	class String_Pool {
+	public:
+
+		/**
+		 * Construct string pool.
+		 *
+		 * @param resource  memory resource that blocks are allocated from
+		 */
+		explicit String_Pool(Memory_Resource *resource = nullptr) noexcept
+				: m_blocks(Resource_Allocator<Block>{resource}) { }
+
+		String_Pool(String_Pool &&other) noexcept
+				: m_blocks(std::move(other.m_blocks)),
+				  m_block{other.m_block},
+				  m_offset{other.m_offset} {
+			other.m_blocks.clear();
+			other.clear();
+		}
+
+		String_Pool &operator=(String_Pool &&other) noexcept {
+			if (this != &other) {
+				release();
+				m_blocks = std::move(other.m_blocks);
+				m_block = other.m_block;
+				m_offset = other.m_offset;
+				other.m_blocks.clear();
+				other.clear();
+			}
+			return *this;
+		}
+
+		~String_Pool() {
+			release();
+		}
+
+		/* Disable copy operations */
+		String_Pool(const String_Pool &) = delete;
+		String_Pool &operator=(const String_Pool &) = delete;
+
+		/**
+		 * Copy the string into the pool.
+		 *
+		 * @param str  string to copy
+		 * @return a view of the pooled copy
+		 */
+		String_View intern(String_View str) {
+			const auto dest = allocate(str.size());
+			std::memcpy(dest, str.data(), str.size());
+			return String_View{dest, str.size()};
+		}
+
+		/**
+		 * Allocate a null-terminated string of the given size in the pool, for the
+		 * caller to fill in. The string stays valid as for intern().
+		 *
+		 * @param size  number of characters, excluding the terminator
+		 * @return the string's characters
+		 */
+		char *allocate(std::size_t size) {
+			if (m_block == m_blocks.size() || m_blocks[m_block].size - m_offset < size + 1)
+				next_block(size + 1);
+			auto dest = m_blocks[m_block].data + m_offset;
+			dest[size] = '\0';
+			m_offset += size + 1;
+			return dest;
+		}
+
+		/**
+		 * Invalidate all pooled strings.
+		 *
+		 * The allocated blocks are kept for reuse by subsequent intern() and
+		 * allocate() calls.
+		 */
+		void clear() noexcept {
+			m_block = 0;
+			m_offset = 0;
+		}
+
+	private:
+
+		/** Size of the first block */
+		static constexpr std::size_t MIN_BLOCK_SIZE{256};
+
+		/** Size beyond which blocks stop growing */
+		static constexpr std::size_t MAX_BLOCK_SIZE{4096};
+
+		struct Block {
+			char *data;
+			std::size_t size;
+		};
+
+		Resource_Vector<Block> m_blocks;
+		std::size_t m_block{0};
+		std::size_t m_offset{0};
+
+		/**
+		 * Advance to the next block that can fit @a size bytes, allocating one if
+		 * necessary.
+		 */
+		void next_block(std::size_t size) {
+			if (m_block < m_blocks.size())
+				++m_block;
+			while (m_block < m_blocks.size() && m_blocks[m_block].size < size)
+				++m_block;
+			if (m_block == m_blocks.size()) {
+				std::size_t block_size = MIN_BLOCK_SIZE;
+				if (!m_blocks.empty()) {
+					block_size = m_blocks.back().size * 2;
+					if (block_size > MAX_BLOCK_SIZE)
+						block_size = MAX_BLOCK_SIZE;
+				}
+				if (size > block_size)
+					block_size = size;
+				Resource_Allocator<char> allocator{m_blocks.get_allocator()};
+				const auto data = allocator.allocate(block_size);
+				CPPARSE_TRY {
+					m_blocks.push_back(Block{data, block_size});
+				} CPPARSE_CATCH_ALL {
+					allocator.deallocate(data, block_size);
+					CPPARSE_RETHROW;
+				}
+			}
+			m_offset = 0;
+		}
+
+		/**
+		 * Return all blocks to the memory resource.
+		 */
+		void release() noexcept {
+			Resource_Allocator<char> allocator{m_blocks.get_allocator()};
+			for (const auto &block : m_blocks)
+				allocator.deallocate(block.data, block.size);
+			m_blocks.clear();
+			clear();
+		}
+
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_STRING_POOL_H_ */
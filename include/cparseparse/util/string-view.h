@@ -0,0 +1,119 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_STRING_VIEW_H_
+#define CPARSEPARSE_UTIL_STRING_VIEW_H_
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif /* __cplusplus >= 201703L */
+
+namespace cpparse {
+
+#if __cplusplus >= 201703L
+	using String_View = std::string_view;
+#else
+	/**
+	 * Minimal non-owning string reference for C++11/14.
+	 *
+	 * Provides the subset of the @a std::string_view interface used by the parser.
+	 */
+	class String_View {
+	public:
+		using const_iterator = const char *;
+
+		constexpr String_View() noexcept
+				: m_data{""},
+				  m_size{0} { }
+
+		constexpr String_View(const char *data, std::size_t size) noexcept
+				: m_data{data},
+				  m_size{size} { }
+
+		String_View(const char *str) noexcept
+				: m_data{str},
+				  m_size{std::strlen(str)} { }
+
+		String_View(const std::string &str) noexcept
+				: m_data{str.data()},
+				  m_size{str.size()} { }
+
+		constexpr const char *data() const noexcept {
+			return m_data;
+		}
+
+		constexpr std::size_t size() const noexcept {
+			return m_size;
+		}
+
+		constexpr std::size_t length() const noexcept {
+			return m_size;
+		}
+
+		constexpr bool empty() const noexcept {
+			return m_size == 0;
+		}
+
+		constexpr const char &operator[](std::size_t idx) const noexcept {
+			return m_data[idx];
+		}
+
+		constexpr const_iterator begin() const noexcept {
+			return m_data;
+		}
+
+		constexpr const_iterator end() const noexcept {
+			return m_data + m_size;
+		}
+
+		int compare(String_View other) const noexcept {
+			const auto cmp = std::memcmp(m_data, other.m_data, m_size < other.m_size ? m_size : other.m_size);
+			if (cmp != 0)
+				return cmp;
+			return m_size == other.m_size ? 0 : (m_size < other.m_size ? -1 : 1);
+		}
+
+		explicit operator std::string() const {
+			return std::string(m_data, m_size);
+		}
+
+	private:
+		const char *m_data;
+		std::size_t m_size;
+	};
+
+	inline bool operator==(String_View lhs, String_View rhs) noexcept {
+		return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+	}
+
+	inline bool operator!=(String_View lhs, String_View rhs) noexcept {
+		return !(lhs == rhs);
+	}
+
+	inline bool operator<(String_View lhs, String_View rhs) noexcept {
+		return lhs.compare(rhs) < 0;
+	}
+
+	inline std::ostream &operator<<(std::ostream &out, String_View view) {
+		return out.write(view.data(), view.size());
+	}
+#endif /* __cplusplus >= 201703L */
+
+	/**
+	 * Materialize the view as an owning @a std::string.
+	 */
+	inline std::string to_string(String_View view) {
+		return std::string(view.data(), view.size());
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_STRING_VIEW_H_ */
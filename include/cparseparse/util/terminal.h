@@ -0,0 +1,52 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_TERMINAL_H_
+#define CPARSEPARSE_UTIL_TERMINAL_H_
+
+#include <cstddef>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/ioctl.h>
+#include <unistd.h>
+#define CPPARSE_HAS_TERMINAL_SIZE 1
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+namespace cpparse {
+
+	/** Width assumed when the terminal width cannot be determined */
+	static constexpr std::size_t DEFAULT_TERMINAL_WIDTH{80};
+
+	/**
+	 * Determine the width of the terminal that standard output is written to.
+	 *
+	 * The @p COLUMNS environment variable takes precedence, as set by shells for
+	 * their children; otherwise the terminal is queried, which fails when the
+	 * output is redirected to a file or a pipe.
+	 *
+	 * @return the terminal width in columns, or DEFAULT_TERMINAL_WIDTH if it
+	 *         cannot be determined
+	 */
+	inline std::size_t terminal_width() noexcept {
+		const auto columns = std::getenv("COLUMNS");
+		if (columns) {
+			char *end;
+			const auto width = std::strtoul(columns, &end, 10);
+			if (end != columns && *end == '\0' && width > 0)
+				return static_cast<std::size_t>(width);
+		}
+#ifdef CPPARSE_HAS_TERMINAL_SIZE
+		struct winsize size;
+		if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0)
+			return size.ws_col;
+#endif /* CPPARSE_HAS_TERMINAL_SIZE */
+		return DEFAULT_TERMINAL_WIDTH;
+	}
+
+}
+
+#endif /* CPARSEPARSE_UTIL_TERMINAL_H_ */
@@ -0,0 +1,245 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#ifndef CPARSEPARSE_UTIL_VALUE_CACHE_H_
+#define CPARSEPARSE_UTIL_VALUE_CACHE_H_
+
+#include "cparseparse/util/memory.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace cpparse {
+
+	/**
+	 * @return an address that uniquely identifies type @a T
+	 */
+	template<class T>
+	const void *type_tag() noexcept {
+		static const char tag{0};
+		return &tag;
+	}
+
+	/**
+	 * Argument values converted to type @a T.
+	 *
+	 * Only the values that converted are constructed, in order, in storage reserved
+	 * up front. Values that failed to convert are not stored; their conversion is
+	 * re-attempted (and the error raised) on access.
+	 *
+	 * The values are kept in a std::vector, which args_ref() returns by reference
+	 * when every value converted, so only the positions of the converted values
+	 * are allocated from the memory resource, and only once a value has failed.
+	 */
+	template<class T>
+	struct Cached_Values {
+		/** Position of a value that failed to convert */
+		static constexpr std::size_t FAILED{static_cast<std::size_t>(-1)};
+
+		explicit Cached_Values(std::size_t count, Memory_Resource *resource = nullptr)
+				: slots(Resource_Allocator<std::size_t>{resource}) {
+			values.reserve(count);
+		}
+
+		/**
+		 * @return true if the value at index @a idx converted, or false otherwise
+		 */
+		bool converted(std::size_t idx) const noexcept {
+			return complete || slots[idx] != FAILED;
+		}
+
+		/**
+		 * @return the value at index @a idx, which must have converted
+		 */
+		typename std::vector<T>::const_reference value(std::size_t idx) const noexcept {
+			return values[complete ? idx : slots[idx]];
+		}
+
+		/**
+		 * Add the next value, converted.
+		 */
+		template<class U>
+		void add(U &&value) {
+			if (!complete)
+				slots.push_back(values.size());
+			values.push_back(std::forward<U>(value));
+		}
+
+		/**
+		 * Add the next value as failed to convert.
+		 */
+		void add_failed() {
+			if (complete) {
+				slots.reserve(values.capacity());
+				for (std::size_t i = 0; i < values.size(); ++i)
+					slots.push_back(i);
+				complete = false;
+			}
+			slots.push_back(FAILED);
+		}
+
+		std::vector<T> values;               // values that converted
+		Resource_Vector<std::size_t> slots;  // position in values of each value, unless complete
+		bool complete{true};
+	};
+
+	template<class T>
+	constexpr std::size_t Cached_Values<T>::FAILED;
+
+	/**
+	 * Per-type cache of converted argument values.
+	 *
+	 * Each type is converted at most once. Entries are published with a lock-free
+	 * list so that concurrent readers may fill the cache; clear() and the move
+	 * operations must not race with readers.
+	 */
+	class Value_Cache {
+	public:
+
+		/**
+		 * Construct cache.
+		 *
+		 * @param resource  memory resource that the entries are allocated from (null
+		 *                  for the default resource); must outlive the cache
+		 */
+		explicit Value_Cache(Memory_Resource *resource = nullptr) noexcept
+				: m_resource{resource} { }
+
+		~Value_Cache() {
+			clear();
+		}
+
+		Value_Cache(Value_Cache &&other) noexcept
+				: m_resource{other.m_resource},
+				  m_head{other.m_head.exchange(nullptr, std::memory_order_acq_rel)} { }
+
+		Value_Cache &operator=(Value_Cache &&other) noexcept {
+			if (this != &other) {
+				clear();
+				m_resource = other.m_resource;
+				m_head.store(other.m_head.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+			}
+			return *this;
+		}
+
+		/* Disable copy operations */
+		Value_Cache(const Value_Cache &) = delete;
+		Value_Cache &operator=(const Value_Cache &) = delete;
+
+		/**
+		 * @return the memory resource that the entries are allocated from
+		 */
+		Memory_Resource *resource() const noexcept {
+			return m_resource;
+		}
+
+		/**
+		 * Look up the cached values for type @a T.
+		 *
+		 * @return the cached values, or null if type @a T has not been cached
+		 */
+		template<class T>
+		const Cached_Values<T> *find() const noexcept {
+			return find<T>(m_head.load(std::memory_order_acquire));
+		}
+
+		/**
+		 * Insert the values for type @a T.
+		 *
+		 * If another thread inserted values for the same type first, @a values is
+		 * discarded in favor of the existing entry.
+		 *
+		 * @return the cached values
+		 */
+		template<class T>
+		const Cached_Values<T> &insert(Cached_Values<T> &&values) const {
+			auto node = make_resource_unique<Node<T>>(m_resource, std::move(values));
+			node->next = m_head.load(std::memory_order_acquire);
+			while (!m_head.compare_exchange_weak(node->next, node.get(), std::memory_order_release, std::memory_order_acquire)) {
+				const auto existing = find<T>(node->next);
+				if (existing)
+					return *existing;
+			}
+			return node.release()->values;
+		}
+
+		/**
+		 * Append a value converted to type @a T while the values are matched, so
+		 * that retrieving them as type @a T does not convert them again.
+		 *
+		 * The entry for type @a T is created by the first call and grown in place.
+		 * Only the thread filling the values may call this, before they are read.
+		 */
+		template<class T>
+		void append(const T &value) {
+			auto node = m_head.load(std::memory_order_relaxed);
+			while (node && node->tag != type_tag<T>())
+				node = node->next;
+			auto &cached = node ? static_cast<Node<T> *>(node)->values : const_cast<Cached_Values<T> &>(insert(Cached_Values<T>{0, m_resource}));
+			cached.add(value);
+		}
+
+		/**
+		 * Discard all cached values.
+		 */
+		void clear() noexcept {
+			auto node = m_head.exchange(nullptr, std::memory_order_acquire);
+			while (node) {
+				const auto next = node->next;
+				node->destroy(m_resource);
+				node = next;
+			}
+		}
+
+	private:
+
+		struct Node_Base {
+			explicit Node_Base(const void *tag) noexcept
+					: tag{tag} { }
+
+			virtual ~Node_Base() = default;
+
+			/**
+			 * Destroy the node, which was allocated from the resource.
+			 */
+			virtual void destroy(Memory_Resource *resource) noexcept = 0;
+
+			const void *tag;
+			Node_Base *next{nullptr};
+		};
+
+		template<class T>
+		struct Node : Node_Base {
+			explicit Node(Cached_Values<T> &&values) noexcept
+					: Node_Base{type_tag<T>()},
+					  values(std::move(values)) { }
+
+			void destroy(Memory_Resource *resource) noexcept override {
+				Resource_Deleter<Node>{resource}(this);
+			}
+
+			Cached_Values<T> values;
+		};
+
+		Memory_Resource *m_resource;
+		mutable std::atomic<Node_Base *> m_head{nullptr};
+
+		template<class T>
+		static const Cached_Values<T> *find(const Node_Base *node) noexcept {
+			for (; node; node = node->next) {
+				if (node->tag == type_tag<T>())
+					return &static_cast<const Node<T> *>(node)->values;
+			}
+			return nullptr;
+		}
+
+	};
+
+}
+
+#endif /* CPARSEPARSE_UTIL_VALUE_CACHE_H_ */
@@ -0,0 +1,23 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+/*
+ * Compiled library mode: the out-of-line Argument_Parser functions and the
+ * common conversions, built once with CPPARSE_COMPILED_LIB defined.
+ */
+
+#include "cparseparse/argument-parser.h"
+#include "cparseparse/argument-parser-impl.h"
+
+namespace cpparse {
+
+	void CPPARSE_LIB_CONFIG_CHECK() noexcept { }
+
+#define CPPARSE_INSTANTIATE_PARSE_RESULT(T) CPPARSE_PARSE_RESULT_INSTANTIATIONS(, T)
+	CPPARSE_LIBRARY_VALUE_TYPES(CPPARSE_INSTANTIATE_PARSE_RESULT)
+#undef CPPARSE_INSTANTIATE_PARSE_RESULT
+
+}
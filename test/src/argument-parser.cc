@@ -5,7 +5,17 @@
  */
 
 #include "cparseparse/argument-parser.h"
+#include "cparseparse/config-reloader.h"
+#include "cparseparse/converters.h"
 #include <catch2/catch.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <type_traits>
 
 using namespace Catch::Matchers;
 using namespace cpparse;
@@ -58,6 +68,59 @@ TEST_CASE("Argument_Parser help text") {
 	REQUIRE(help_contains(parser, help_text));
 }
 
+TEST_CASE("Argument_Parser help layout") {
+	static_assert(std::is_move_constructible<Argument_Parser>::value && std::is_move_assignable<Argument_Parser>::value,
+			"the help text cache must not make the parser immovable");
+
+	const auto help_of = [](const Argument_Parser &parser) {
+		std::ostringstream out;
+		parser.print_help(out);
+		return out.str();
+	};
+
+	SECTION("column") {
+		Argument_Parser parser{Argument_Parser::Options{}.auto_help(false)};
+		parser.add_positional("file").help("input file");
+		auto &jobs = parser.add_optional("-j", "--jobs").help("worker count");
+		parser.add_optional("--verbose", Opt_Type::FLAG);
+		REQUIRE(help_of(parser) == "Usage:  [options] <file>\n"
+				"\nPositional arguments:\n"
+				"  file             input file\n"
+				"\nOptions:\n"
+				"  -j, --jobs JOBS  worker count\n"
+				"  --verbose\n");
+
+		jobs.help("number of workers").env("JOBS");
+		parser.add_optional("--a-very-long-option-name").help("rarely used");
+		REQUIRE(help_of(parser) == "Usage:  [options] <file>\n"
+				"\nPositional arguments:\n"
+				"  file             input file\n"
+				"\nOptions:\n"
+				"  -j, --jobs JOBS  number of workers [env: JOBS]\n"
+				"  --verbose\n"
+				"  --a-very-long-option-name A-VERY-LONG-OPTION-NAME\n"
+				"                   rarely used\n");
+	}
+
+	SECTION("wrapping") {
+		Argument_Parser parser{Argument_Parser::Options{}.auto_help(false).help_width(40)};
+		parser.set_description("sorts the lines of the given files and writes them out");
+		parser.add_optional("-o", "--output").help("file to write the sorted lines to instead of stdout");
+		parser.add_subcommand("check", [](Argument_Parser &) { }, "check whether the input is already sorted");
+		REQUIRE(help_of(parser) == "Usage:  [options] <command> [args]\n"
+				"\n  sorts the lines of the given files and\n"
+				"  writes them out\n"
+				"\nCommands:\n"
+				"  check                check whether the\n"
+				"                       input is already\n"
+				"                       sorted\n"
+				"\nOptions:\n"
+				"  -o, --output OUTPUT  file to write the\n"
+				"                       sorted lines to\n"
+				"                       instead of stdout\n");
+	}
+}
+
 TEST_CASE("Argument_Parser help handler") {
 	bool invoked{false};
 	Argument_Parser parser{};
@@ -136,7 +199,8 @@ TEST_CASE("Argument_Parser parse_args()") {
 		}
 		SECTION("Flag argument") {
 			parser.add_optional("-o", "--opt0", Opt_Type::FLAG);
-			REQUIRE_THROWS_WITH(call_parse_args({"test-program", "-o", "--opt0"}), EndsWith("should only be specified once"));
+			REQUIRE(call_parse_args({"test-program", "-o", "--opt0"}).empty());
+			REQUIRE(parser.arg_count("opt0") == 2);
 			const auto args = call_parse_args({"test-program", "-o", "extra1"});
 			REQUIRE(args.size() == 1);
 			REQUIRE(args.at(0) == "extra1");
@@ -232,14 +296,14 @@ TEST_CASE("Argument_Parser arg()") {
 		REQUIRE_THROWS_WITH(parser.arg<char>("barg"), EndsWith("must be a single character"));
 		REQUIRE_THROWS_WITH(parser.arg<uint>("barg"), EndsWith("must be of integral type"));
 		REQUIRE_THROWS_WITH(parser.arg<int>("barg"), EndsWith("must be of integral type"));
-		REQUIRE_THROWS_WITH(parser.arg<double>("barg"), EndsWith("must be of integral type"));
+		REQUIRE_THROWS_WITH(parser.arg<double>("barg"), EndsWith("must be of floating-point type"));
 		REQUIRE(parser.arg<std::string>("barg") == "true");
 
 		REQUIRE_THROWS_WITH(parser.arg<bool>("carg"), EndsWith("must be one of: 'true', 'false', 'yes', 'no', 'on', 'off'"));
 		REQUIRE(parser.arg<char>("carg") == 'r');
 		REQUIRE_THROWS_WITH(parser.arg<uint>("carg"), EndsWith("must be of integral type"));
 		REQUIRE_THROWS_WITH(parser.arg<int>("carg"), EndsWith("must be of integral type"));
-		REQUIRE_THROWS_WITH(parser.arg<double>("carg"), EndsWith("must be of integral type"));
+		REQUIRE_THROWS_WITH(parser.arg<double>("carg"), EndsWith("must be of floating-point type"));
 		REQUIRE(parser.arg<std::string>("carg") == "r");
 
 		REQUIRE_THROWS_WITH(parser.arg<bool>("uiarg"), EndsWith("must be one of: 'true', 'false', 'yes', 'no', 'on', 'off'"));
@@ -267,7 +331,1444 @@ TEST_CASE("Argument_Parser arg()") {
 		REQUIRE_THROWS_WITH(parser.arg<char>("sarg"), EndsWith("must be a single character"));
 		REQUIRE_THROWS_WITH(parser.arg<uint>("sarg"), EndsWith("must be of integral type"));
 		REQUIRE_THROWS_WITH(parser.arg<int>("sarg"), EndsWith("must be of integral type"));
-		REQUIRE_THROWS_WITH(parser.arg<double>("sarg"), EndsWith("must be of integral type"));
+		REQUIRE_THROWS_WITH(parser.arg<double>("sarg"), EndsWith("must be of floating-point type"));
 		REQUIRE(parser.arg<std::string>("sarg") == "abc123");
 	}
 }
+
+TEST_CASE("Argument_Parser value storage") {
+	char single_value[] = "abc";
+	char append_value[] = "def";
+	char pos_value[] = "ghi";
+	std::vector<const char *> args{"test-program", "--single", single_value, "--append", append_value, pos_value};
+
+	SECTION("Copied values") {
+		Argument_Parser parser{};
+		auto &single = parser.add_optional("--single", Opt_Type::SINGLE);
+		auto &append = parser.add_optional("--append", Opt_Type::APPEND);
+		auto &pos = parser.add_positional("pos");
+		invoke_parse_args(parser, args);
+		single_value[0] = append_value[0] = pos_value[0] = 'x';
+		REQUIRE(single.as_type<std::string>() == "abc");
+		REQUIRE(append.as_type_at<std::string>(0) == "def");
+		REQUIRE(pos.as_type<std::string>() == "ghi");
+		REQUIRE(single.as_type<String_View>().data() != single_value);
+	}
+	SECTION("Referenced values") {
+		Argument_Parser parser{Argument_Parser::Options{}.copy_args(false)};
+		auto &single = parser.add_optional("--single", Opt_Type::SINGLE);
+		auto &append = parser.add_optional("--append", Opt_Type::APPEND);
+		auto &pos = parser.add_positional("pos");
+		invoke_parse_args(parser, args);
+		REQUIRE(single.as_type<String_View>().data() == single_value);
+		REQUIRE(append.as_type_at<String_View>(0).data() == append_value);
+		REQUIRE(pos.as_type<String_View>().data() == pos_value);
+		REQUIRE(parser.arg<String_View>("single") == "abc");
+		REQUIRE(parser.arg<std::string>("append") == "def");
+	}
+}
+
+TEST_CASE("Argument_Parser cached conversions") {
+	Argument_Parser parser{};
+	auto &append = parser.add_optional("--append", Opt_Type::APPEND);
+	auto &pos = parser.add_positional("pos");
+	invoke_parse_args(parser, {"test-program", "--append", "1", "--append", "x", "--append", "3", "42"});
+
+	REQUIRE(append.as_type_at<int>(0) == 1);
+	REQUIRE(append.as_type_at<int>(2) == 3);
+	REQUIRE_THROWS_WITH(append.as_type_at<int>(1), EndsWith("must be of integral type"));
+	REQUIRE_THROWS_WITH(parser.args_ref<int>("append"), EndsWith("must be of integral type"));
+	REQUIRE(pos.as_type<int>() == 42);
+	REQUIRE(pos.as_type<int>() == 42);
+
+	const auto &strings = parser.args_ref<std::string>("append");
+	REQUIRE(&strings == &parser.args_ref<std::string>("append"));
+	REQUIRE(strings == std::vector<std::string>{"1", "x", "3"});
+	REQUIRE(parser.args<std::string>("append") == strings);
+
+	invoke_parse_args(parser, {"test-program", "--append", "4", "5"});
+	REQUIRE(parser.args_ref<int>("append") == std::vector<int>{4});
+	REQUIRE(pos.as_type<int>() == 5);
+}
+
+TEST_CASE("Argument_Parser argument handles") {
+	Argument_Parser parser{};
+	const auto pos = parser.add_positional("pos").handle<int>();
+	const auto single = parser.add_optional("-s", "--single", Opt_Type::SINGLE).handle<double>();
+	const auto append = parser.add_optional("--append", Opt_Type::APPEND).handle<std::string>();
+	const auto flag = parser.add_optional("--flag", Opt_Type::FLAG).handle<bool>();
+	const auto unused = parser.add_optional("--unused", Opt_Type::SINGLE).handle<int>();
+	invoke_parse_args(parser, {"test-program", "7", "-s", "2.5", "--append", "a", "--append", "b"});
+
+	REQUIRE(parser.arg(pos) == 7);
+	REQUIRE(parser.arg(single) == 2.5);
+	REQUIRE(parser.has_arg(single));
+	REQUIRE(parser.arg_count(append) == 2);
+	REQUIRE(parser.arg_at(append, 1) == "b");
+	REQUIRE(parser.args(append) == std::vector<std::string>{"a", "b"});
+	REQUIRE(&parser.args_ref(append) == &parser.args_ref(append));
+	REQUIRE(!parser.arg(flag));
+	REQUIRE(!parser.has_arg(unused));
+	REQUIRE(parser.arg(unused, 3) == 3);
+	REQUIRE_THROWS_WITH(parser.arg(unused), EndsWith("no value given for 'unused' and no default specified"));
+	REQUIRE_THROWS_WITH(parser.has_arg(pos), EndsWith("handle does not refer to an optional argument"));
+}
+
+TEST_CASE("Argument_Parser value callbacks") {
+	Argument_Parser parser{};
+	std::vector<int> numbers;
+	std::vector<std::string> patterns;
+	auto &number = parser.add_optional("-n", "--number", Opt_Type::APPEND).on_value<int>([&numbers](int value) { numbers.push_back(value); });
+	auto &include = parser.add_optional("-i", "--include", Opt_Type::APPEND).on_value<String_View>([&patterns](String_View value) { patterns.push_back(to_string(value)); });
+	std::size_t verbose_calls{0};
+	parser.add_optional("-v", "--verbose", Opt_Type::FLAG).on_value<bool>([&verbose_calls](bool value) { verbose_calls += value; });
+
+	invoke_parse_args(parser, {"test-program", "-n", "1", "-i", "*.h", "--number", "-2", "-v", "-i", "*.cc"});
+	REQUIRE(numbers == std::vector<int>{1, -2});
+	REQUIRE(patterns == std::vector<std::string>{"*.h", "*.cc"});
+	REQUIRE(verbose_calls == 1);
+	REQUIRE(number.count() == 2);
+	REQUIRE(include.exists());
+	REQUIRE(parser.arg_count("include") == 2);
+	REQUIRE(parser.has_arg("verbose"));
+	REQUIRE(parser.args<std::string>("include").empty());
+	REQUIRE(parser.arg<int>("number", 7) == 7);
+
+	std::istringstream config{"include = *.hpp\n"};
+	invoke_parse_args(parser, {"test-program"});
+	parser.parse_config(config);
+	REQUIRE(patterns.back() == "*.hpp");
+	REQUIRE(include.count() == 1);
+
+	REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-n", "x"}), Equals("test-program: 'number' must be of integral type"));
+	REQUIRE(!number.exists());
+}
+
+TEST_CASE("Argument_Parser delimited values") {
+	Argument_Parser parser{};
+	auto &ids = parser.add_optional("-i", "--ids", Opt_Type::APPEND).delimiter(',');
+	auto &range = parser.add_optional("-r", "--range", Opt_Type::SINGLE).delimiter(':');
+
+	SECTION("Fields are separate values") {
+		invoke_parse_args(parser, {"test-program", "--ids", "1,2,3", "-r", "5:10", "-i", "4"});
+		REQUIRE(ids.as_type_all<int>() == std::vector<int>{1, 2, 3, 4});
+		REQUIRE(ids.count() == 4);
+		REQUIRE(parser.arg_at<int>("ids", 2) == 3);
+		REQUIRE(range.as_type_all<std::string>() == std::vector<std::string>{"5", "10"});
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-r", "1:2", "-r", "3"}), EndsWith("'range' should only be specified once"));
+	}
+
+	SECTION("Empty fields") {
+		invoke_parse_args(parser, {"test-program", "--ids", ",a,,b,"});
+		REQUIRE(ids.as_type_all<std::string>() == std::vector<std::string>{"", "a", "", "b", ""});
+		REQUIRE_THROWS_WITH(parser.args<int>("ids"), Equals("test-program: 'ids' must be of integral type"));
+	}
+
+	SECTION("Long lists") {
+		std::string list;
+		for (int i = 0; i < 100000; ++i)
+			list.append(std::to_string(i)).push_back(',');
+		list.pop_back();
+		invoke_parse_args(parser, {"test-program", "--ids", list.c_str()});
+		const auto &values = parser.args_ref<int>("ids");
+		REQUIRE(values.size() == 100000);
+		REQUIRE(values.front() == 0);
+		REQUIRE(values.back() == 99999);
+	}
+
+	SECTION("Configuration files and callbacks") {
+		std::vector<int> streamed;
+		parser.add_optional("--ports", Opt_Type::APPEND).delimiter(',').on_value<int>([&streamed](int port) { streamed.push_back(port); });
+		std::istringstream config{"ids = \"7,8\"\nports = 80,443\n"};
+		invoke_parse_args(parser, {"test-program", "--ports", "22"});
+		parser.parse_config(config);
+		REQUIRE(ids.as_type_all<int>() == std::vector<int>{7, 8});
+		REQUIRE(streamed == std::vector<int>{22});
+		REQUIRE(parser.arg_count("ports") == 1);
+	}
+
+	SECTION("Help text and errors") {
+		REQUIRE(help_contains(parser, "--ids IDS[,...]"));
+		REQUIRE_THROWS_WITH(parser.add_optional("-v", "--verbose", Opt_Type::FLAG).delimiter(','), Contains("cannot take delimited values"));
+	}
+}
+
+TEST_CASE("Argument_Parser reset()") {
+	Argument_Parser parser{};
+	auto &append = parser.add_optional("-a", "--append", Opt_Type::APPEND);
+	auto &pos = parser.add_positional("pos");
+
+	invoke_parse_args(parser, {"test-program", "-a", "1", "-a", "2", "first"});
+	REQUIRE(append.count() == 2);
+	REQUIRE(parser.arg<std::string>("pos") == "first");
+
+	parser.reset();
+	REQUIRE(!append.exists());
+	REQUIRE(pos.as_type<std::string>().empty());
+	REQUIRE(parser.arg<int>("append", 5) == 5);
+
+	invoke_parse_args(parser, {"test-program", "second", "-a", "3"});
+	REQUIRE(parser.args<int>("append") == std::vector<int>{3});
+	REQUIRE(pos.as_type<std::string>() == "second");
+}
+
+TEST_CASE("Argument_Parser parse()") {
+	Argument_Parser parser{};
+	const auto single = parser.add_optional("-s", "--single", Opt_Type::SINGLE).handle<int>();
+	parser.add_optional("-a", "--append", Opt_Type::APPEND);
+	const auto pos = parser.add_positional("pos").handle<std::string>();
+
+	const char *argv[]{"test-program", "-s", "5", "p", "-a", "x", "extra"};
+	const auto result = parser.parse(7, argv);
+	REQUIRE(result.script_name() == "test-program");
+	REQUIRE(result.arg(single) == 5);
+	REQUIRE(result.arg(pos) == "p");
+	REQUIRE(result.args<std::string>("append") == std::vector<std::string>{"x"});
+	REQUIRE(result.extra_count() == 1);
+	REQUIRE(std::string{result.extra_args()[0]} == "extra");
+	REQUIRE(!result.help_requested());
+	REQUIRE(!parser.has_arg("single"));
+
+	SECTION("Errors carry the parse's script name") {
+		const char *bad_argv[]{"other-program", "-s", "five", "p"};
+		const auto bad = parser.parse(4, bad_argv);
+		REQUIRE_THROWS_WITH(bad.arg(single), StartsWith("other-program: 'single' must be of integral type"));
+		const char *missing_argv[]{"other-program"};
+		REQUIRE_THROWS_WITH(parser.parse(1, missing_argv), StartsWith("other-program: requires positional argument 'pos'"));
+	}
+
+	SECTION("Help is recorded") {
+		const char *help_argv[]{"test-program", "--help"};
+		const auto help = parser.parse(2, help_argv);
+		REQUIRE(help.help_requested());
+	}
+
+	SECTION("Reused result") {
+		Parse_Result reused;
+		REQUIRE_THROWS_WITH(reused.has_arg("single"), EndsWith("result has not been filled by a parser"));
+		const char *next_argv[]{"test-program", "q"};
+		parser.parse(7, argv, reused);
+		parser.parse(2, next_argv, reused);
+		REQUIRE(!reused.has_arg(single));
+		REQUIRE(reused.arg(pos) == "q");
+		REQUIRE(reused.extra_count() == 0);
+	}
+}
+
+TEST_CASE("Argument_Parser concurrent parse()") {
+	Argument_Parser parser{};
+	const auto value = parser.add_optional("-v", "--value", Opt_Type::SINGLE).handle<int>();
+	const auto name = parser.add_positional("name").handle<std::string>();
+
+	std::vector<char> ok(8, false);
+	std::vector<std::thread> threads;
+	for (std::size_t t = 0; t < ok.size(); ++t) {
+		threads.emplace_back([&parser, &ok, value, name, t]() {
+			const auto expected_name = std::to_string(t);
+			const auto expected_value = std::to_string(t * 10);
+			const char *argv[]{"test-program", expected_name.c_str(), "-v", expected_value.c_str()};
+			Parse_Result result;
+			bool thread_ok = true;
+			for (int i = 0; i < 1000; ++i) {
+				parser.parse(4, argv, result);
+				thread_ok = thread_ok && result.arg(value) == static_cast<int>(t * 10) && result.arg(name) == expected_name;
+			}
+			ok[t] = thread_ok;
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+	for (const char thread_ok : ok)
+		REQUIRE(thread_ok);
+}
+
+TEST_CASE("Argument_Parser parse_batch()") {
+	Argument_Parser parser{};
+	const auto count = parser.add_optional("-c", "--count", Opt_Type::SINGLE).handle<int>();
+	const auto name = parser.add_positional("name").handle<std::string>();
+
+	std::vector<std::string> storage;
+	for (int i = 0; i < 1000; ++i)
+		storage.push_back(std::to_string(i));
+	std::vector<std::vector<const char *>> lines;
+	for (int i = 0; i < 1000; ++i) {
+		if (i % 7 == 0)
+			lines.push_back({"test-program", "-c", storage[i].c_str()});
+		else
+			lines.push_back({"test-program", storage[i].c_str(), "-c", storage[i].c_str()});
+	}
+
+	for (const std::size_t threads : {0, 1, 4}) {
+		const auto results = parser.parse_batch(lines, threads);
+		REQUIRE(results.size() == lines.size());
+		bool all_match = true;
+		for (int i = 0; i < 1000; ++i) {
+			const auto &entry = results[i];
+			if (i % 7 == 0)
+				all_match = all_match && !entry.ok() && entry.error() == "test-program: requires positional argument 'name'";
+			else
+				all_match = all_match && entry.ok() && entry.result().arg(count) == i && entry.result().arg(name) == storage[i];
+		}
+		REQUIRE(all_match);
+	}
+
+	REQUIRE(parser.parse_batch(std::vector<std::vector<const char *>>{}).empty());
+	REQUIRE_THROWS_WITH(parser.parse_batch(lines, 2)[0].result().arg(name), EndsWith("result has not been filled by a parser"));
+}
+
+TEST_CASE("Argument_Parser many arguments") {
+	Argument_Parser parser{Argument_Parser::Options{}.auto_help(false)};
+	std::vector<std::string> names;
+	for (int i = 0; i < 300; ++i) {
+		names.push_back("--opt" + std::to_string(i));
+		parser.add_optional(names.back(), Opt_Type::SINGLE);
+	}
+	parser.add_optional("-x", "--extra", Opt_Type::FLAG);
+	parser.add_positional("pos");
+
+	invoke_parse_args(parser, {"test-program", "--opt7", "7", "p", "--opt299", "299", "-x"});
+	REQUIRE(parser.arg<int>("opt7") == 7);
+	REQUIRE(parser.arg<int>("opt299") == 299);
+	REQUIRE(!parser.has_arg("opt150"));
+	REQUIRE(parser.arg<bool>("extra"));
+	REQUIRE(parser.arg<std::string>("pos") == "p");
+	REQUIRE_THROWS_WITH(parser.add_optional("--opt42"), Contains("duplicate optional argument name"));
+	REQUIRE_THROWS_WITH(parser.add_optional("-x", "--other"), Contains("duplicate flag name"));
+	REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-y"}), StartsWith("test-program: invalid flag '-y'"));
+}
+
+TEST_CASE("Argument_Parser error ordering") {
+	Argument_Parser parser{};
+	auto &single = parser.add_optional("-s", "--single", Opt_Type::SINGLE);
+	parser.add_positional("pos");
+
+	REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--bogus"}), StartsWith("test-program: invalid option 'bogus'"));
+	REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-s", "1", "-s", "2", "--bogus"}), EndsWith("'single' should only be specified once"));
+	REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-s", "1"}), EndsWith("requires positional argument 'pos'"));
+	REQUIRE(!single.exists());
+
+	bool help_invoked{false};
+	parser.set_help_handler([&help_invoked](const Argument_Parser &) { help_invoked = true; });
+	REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-h", "--bogus"}), StartsWith("test-program: invalid option 'bogus'"));
+	REQUIRE(help_invoked);
+}
+
+TEST_CASE("Argument_Parser subcommands") {
+	Argument_Parser parser{};
+	auto &verbose = parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+	int built{0};
+	parser.add_subcommand("build", [&built](Argument_Parser &sub) {
+		++built;
+		sub.add_optional("-j", "--jobs", Opt_Type::SINGLE);
+		sub.add_positional("target");
+	}, "build a target");
+	parser.add_subcommand("clean", [](Argument_Parser &) { }, "remove build outputs");
+
+	SECTION("Selected subcommand") {
+		std::vector<const char *> args{"test-program", "-v", "build", "-j", "4", "all", "extra"};
+		int argc = args.size();
+		auto argv = args.data();
+		parser.parse_args(argc, argv);
+		REQUIRE(verbose.exists());
+		REQUIRE(parser.subcommand() == "build");
+		REQUIRE(built == 1);
+		auto &build = parser.subparser("build");
+		REQUIRE(build.arg<int>("jobs") == 4);
+		REQUIRE(build.arg<std::string>("target") == "all");
+		REQUIRE(argc == 2);
+		REQUIRE(std::string{argv[0]} == "test-program");
+		REQUIRE(std::string{argv[1]} == "extra");
+
+		invoke_parse_args(parser, {"test-program", "build", "lib"});
+		REQUIRE(built == 1);
+		REQUIRE(!verbose.exists());
+		REQUIRE(build.arg<std::string>("target") == "lib");
+	}
+
+	SECTION("Subcommands are built on demand") {
+		invoke_parse_args(parser, {"test-program", "clean"});
+		REQUIRE(parser.subcommand() == "clean");
+		REQUIRE(built == 0);
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE(parser.subcommand().empty());
+		REQUIRE(built == 0);
+	}
+
+	SECTION("Errors") {
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "bogus"}), StartsWith("test-program: invalid command 'bogus'"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "build"}), Equals("test-program build: requires positional argument 'target'"));
+		REQUIRE(parser.subcommand().empty());
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "build", "-v", "all"}), StartsWith("test-program build: invalid flag '-v'"));
+		REQUIRE_THROWS_WITH(parser.add_subcommand("build", [](Argument_Parser &) { }), Contains("duplicate subcommand name"));
+		REQUIRE_THROWS_WITH(parser.add_subcommand("-x", [](Argument_Parser &) { }), Contains("invalid subcommand name"));
+		REQUIRE_THROWS_WITH(parser.subparser("bogus"), Contains("no subcommand named 'bogus'"));
+	}
+
+	SECTION("Failed subcommand parse leaves the arguments unchanged") {
+		const std::vector<const char *> args{"test-program", "-v", "build", "-x", "all"};
+		auto copy = args;
+		int argc = copy.size();
+		auto argv = copy.data();
+		const auto status = parser.try_parse_args(argc, argv);
+		REQUIRE(status.code() == Parse_Errc::INVALID_FLAG);
+		REQUIRE(status.message() == "test-program build: invalid flag '-x', pass --help to display possible options");
+		REQUIRE(argc == 5);
+		REQUIRE(argv == copy.data());
+		REQUIRE(copy == args);
+	}
+
+	SECTION("Help text") {
+		REQUIRE(help_contains(parser, "<command> [args]"));
+		REQUIRE(help_contains(parser, "Commands:"));
+		REQUIRE(help_contains(parser, "remove build outputs"));
+		REQUIRE(built == 0);
+	}
+
+	SECTION("parse()") {
+		const std::vector<const char *> args{"test-program", "build", "-j", "2", "all"};
+		const auto result = parser.parse(args.size(), args.data());
+		REQUIRE(result.subcommand() == "build");
+		REQUIRE(result.extra_count() == 4);
+		REQUIRE(built == 0);
+		const auto sub_result = parser.subparser(result.subcommand()).parse(result.extra_count(), result.extra_args());
+		REQUIRE(sub_result.arg<int>("jobs") == 2);
+	}
+}
+
+TEST_CASE("Argument_Parser option abbreviations") {
+	Argument_Parser parser{Argument_Parser::Options{}.allow_abbrev(true)};
+	auto &verbose = parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+	auto &version = parser.add_optional("--version", Opt_Type::FLAG);
+	auto &output = parser.add_optional("--output", Opt_Type::SINGLE);
+	auto &out = parser.add_optional("--out", Opt_Type::SINGLE);
+
+	SECTION("Unique prefixes") {
+		invoke_parse_args(parser, {"test-program", "--verb", "--vers", "--outp", "a.txt", "--out", "b.txt"});
+		REQUIRE(verbose.exists());
+		REQUIRE(version.exists());
+		REQUIRE(output.as_type<std::string>() == "a.txt");
+		REQUIRE(out.as_type<std::string>() == "b.txt");
+	}
+
+	SECTION("Ambiguous prefixes") {
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--ver"}), Equals("test-program: ambiguous option 'ver' could match --verbose, --version"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--outp", "a.txt", "--output", "b.txt"}), EndsWith("'output' should only be specified once"));
+	}
+
+	SECTION("Help") {
+		bool help_invoked{false};
+		parser.set_help_handler([&help_invoked](const Argument_Parser &) { help_invoked = true; });
+		invoke_parse_args(parser, {"test-program", "--he"});
+		REQUIRE(help_invoked);
+	}
+
+	SECTION("Disabled by default") {
+		Argument_Parser exact{};
+		exact.add_optional("--verbose", Opt_Type::FLAG);
+		REQUIRE_THROWS_WITH(invoke_parse_args(exact, {"test-program", "--verb"}), StartsWith("test-program: invalid option 'verb' (did you mean '--verbose'?)"));
+	}
+
+	SECTION("Suggestions") {
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--verbsoe"}), StartsWith("test-program: invalid option 'verbsoe' (did you mean '--verbose'?)"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--ouptut", "a"}), Contains("did you mean '--output'?"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--bogus"}), Equals("test-program: invalid option 'bogus', pass --help to display possible options"));
+	}
+
+	SECTION("Options added after a lookup") {
+		invoke_parse_args(parser, {"test-program", "--verb"});
+		auto &alpha = parser.add_optional("--alpha", Opt_Type::FLAG);
+		auto &zeta = parser.add_optional("--zeta", Opt_Type::FLAG);
+		std::vector<char> ok(4, false);
+		std::vector<std::thread> threads;
+		for (std::size_t t = 0; t < ok.size(); ++t) {
+			threads.emplace_back([&parser, &ok, t]() {
+				const char *argv[]{"test-program", "--al", "--ze", "--outp", "a.txt"};
+				ok[t] = parser.parse(5, argv).arg<bool>("zeta");
+			});
+		}
+		for (auto &thread : threads)
+			thread.join();
+		for (const char thread_ok : ok)
+			REQUIRE(thread_ok);
+		invoke_parse_args(parser, {"test-program", "--al", "--ze"});
+		REQUIRE(alpha.exists());
+		REQUIRE(zeta.exists());
+	}
+}
+
+TEST_CASE("Argument_Parser short flag clusters") {
+	Argument_Parser parser{};
+	auto &verbose = parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+	auto &extract = parser.add_optional("-x", "--extract", Opt_Type::FLAG);
+	auto &gzip = parser.add_optional("-z", "--gzip", Opt_Type::FLAG);
+	auto &file = parser.add_optional("-f", "--file", Opt_Type::SINGLE);
+	auto &jobs = parser.add_optional("-j", "--jobs", Opt_Type::SINGLE);
+	auto &include = parser.add_optional("-I", "--include", Opt_Type::APPEND);
+
+	SECTION("Flags and values") {
+		invoke_parse_args(parser, {"test-program", "-xzv", "-j8", "-I/usr/include", "-Iinclude", "-vfout.txt"});
+		REQUIRE(extract.exists());
+		REQUIRE(gzip.exists());
+		REQUIRE(verbose.exists());
+		REQUIRE(verbose.count() == 2);
+		REQUIRE(file.as_type<std::string>() == "out.txt");
+		REQUIRE(jobs.as_type<int>() == 8);
+		REQUIRE(include.as_type_all<std::string>() == std::vector<std::string>{"/usr/include", "include"});
+	}
+
+	SECTION("Value in the next argument") {
+		invoke_parse_args(parser, {"test-program", "-xzf", "archive.tar", "-v"});
+		REQUIRE(extract.exists());
+		REQUIRE(file.as_type<std::string>() == "archive.tar");
+		REQUIRE(verbose.exists());
+	}
+
+	SECTION("Repeated flags are counted") {
+		invoke_parse_args(parser, {"test-program", "-vvv", "--verbose"});
+		REQUIRE(verbose.count() == 4);
+		REQUIRE(parser.arg_count("verbose") == 4);
+		REQUIRE(parser.arg<bool>("verbose"));
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE(parser.arg_count("verbose") == 0);
+	}
+
+	SECTION("Long options take precedence") {
+		Argument_Parser long_parser{};
+		auto &single_dash = long_parser.add_optional("--xzf", Opt_Type::FLAG);
+		long_parser.add_optional("-x", "--extract", Opt_Type::FLAG);
+		invoke_parse_args(long_parser, {"test-program", "-xzf"});
+		REQUIRE(single_dash.exists());
+		REQUIRE(!long_parser.has_arg("extract"));
+	}
+
+	SECTION("Errors") {
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-xqf", "a"}), Equals("test-program: invalid flag '-q' in '-xqf', pass --help to display possible options"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-xf"}), Equals("test-program: 'file' requires a value"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-j1", "-j2"}), Equals("test-program: 'jobs' should only be specified once"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "-qx"}), StartsWith("test-program: invalid option 'qx'"));
+		std::vector<const char *> args{"test-program", "-xvq"};
+		int argc = args.size();
+		auto argv = args.data();
+		const auto status = parser.try_parse_args(argc, argv);
+		REQUIRE(status.code() == Parse_Errc::INVALID_FLAG);
+		REQUIRE(status.arg_index() == 1);
+		REQUIRE(status.token() == "q");
+	}
+
+	SECTION("Completion") {
+		const auto complete = [&parser](std::vector<const char *> words) {
+			std::stringstream ss;
+			parser.print_completions(words.size(), words.data(), ss);
+			return ss.str();
+		};
+		REQUIRE(complete({"-xvf", "--"}).empty());
+		REQUIRE(complete({"-xvfout", "--j"}) == "--jobs\n");
+	}
+}
+
+TEST_CASE("Argument_Parser shell completion") {
+	Argument_Parser parser{};
+	parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+	parser.add_optional("-o", "--output", Opt_Type::SINGLE);
+	parser.add_optional("--log-level", Opt_Type::SINGLE);
+	int built{0};
+	parser.add_subcommand("build", [&built](Argument_Parser &sub) {
+		++built;
+		sub.add_optional("-j", "--jobs", Opt_Type::SINGLE);
+	});
+	parser.add_subcommand("bundle", [](Argument_Parser &) { });
+	parser.add_subcommand("clean", [](Argument_Parser &) { });
+
+	const auto complete = [&parser](std::vector<const char *> words) {
+		std::stringstream ss;
+		parser.print_completions(words.size(), words.data(), ss);
+		return ss.str();
+	};
+
+	SECTION("Options") {
+		REQUIRE(complete({"--"}) == "--help\n--log-level\n--output\n--verbose\n");
+		REQUIRE(complete({"--lo"}) == "--log-level\n");
+		REQUIRE(complete({"-"}) == "--help\n--log-level\n--output\n--verbose\n-h\n-o\n-v\n");
+		REQUIRE(complete({"-v"}) == "-v\n");
+		REQUIRE(complete({"--bogus"}).empty());
+	}
+
+	SECTION("Subcommands") {
+		REQUIRE(complete({}) == "build\nbundle\nclean\n");
+		REQUIRE(complete({"-v", "b"}) == "build\nbundle\n");
+		REQUIRE(complete({"-o", ""}).empty());
+		REQUIRE(complete({"-o", "out", "c"}) == "clean\n");
+		REQUIRE(built == 0);
+		REQUIRE(complete({"build", "--"}) == "--help\n--jobs\n");
+		REQUIRE(built == 1);
+		REQUIRE(complete({"build", "-j", ""}).empty());
+	}
+
+	SECTION("Options end at the separator") {
+		Argument_Parser plain_parser{};
+		auto &verbose = plain_parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+		plain_parser.add_positional("input");
+		std::vector<const char *> args{"prog", "a", "--", "-v", "--", "--verbose"};
+		int argc = args.size();
+		auto argv = args.data();
+		plain_parser.parse_args(argc, argv);
+		REQUIRE(!verbose.exists());
+		REQUIRE(plain_parser.arg<std::string>("input") == "a");
+		REQUIRE(std::vector<std::string>(argv + 1, argv + argc) == std::vector<std::string>{"-v", "--", "--verbose"});
+
+		std::stringstream ss;
+		const std::vector<const char *> words{"a", "--", "-"};
+		plain_parser.print_completions(words.size(), words.data(), ss);
+		REQUIRE(ss.str().empty());
+	}
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("Argument_Parser environment variables") {
+	Argument_Parser parser{};
+	auto &jobs = parser.add_optional("-j", "--jobs", Opt_Type::SINGLE).env("CPPARSE_TEST_JOBS");
+	auto &verbose = parser.add_optional("-v", "--verbose", Opt_Type::FLAG).env("CPPARSE_TEST_VERBOSE");
+	auto &paths = parser.add_optional("--path", Opt_Type::APPEND).delimiter(':').env("CPPARSE_TEST_PATH");
+	auto &level = parser.add_optional("--level", Opt_Type::SINGLE).env("CPPARSE_TEST_LEVEL");
+	::setenv("CPPARSE_TEST_JOBS", "8", 1);
+	::setenv("CPPARSE_TEST_VERBOSE", "yes", 1);
+	::setenv("CPPARSE_TEST_PATH", "/bin:/usr/bin", 1);
+	::unsetenv("CPPARSE_TEST_LEVEL");
+
+	SECTION("Fallback values") {
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE(jobs.as_type<int>() == 8);
+		REQUIRE(verbose.exists());
+		REQUIRE(paths.as_type_all<std::string>() == std::vector<std::string>{"/bin", "/usr/bin"});
+		REQUIRE(!level.exists());
+		REQUIRE(parser.arg<int>("level", 3) == 3);
+		REQUIRE(jobs.as_type<String_View>().data() == std::getenv("CPPARSE_TEST_JOBS"));
+	}
+
+	SECTION("Command line takes precedence") {
+		invoke_parse_args(parser, {"test-program", "-j", "2", "--path", "/opt"});
+		REQUIRE(jobs.as_type<int>() == 2);
+		REQUIRE(paths.as_type_all<std::string>() == std::vector<std::string>{"/opt"});
+		::setenv("CPPARSE_TEST_VERBOSE", "off", 1);
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE(!verbose.exists());
+	}
+
+	SECTION("Errors") {
+		::setenv("CPPARSE_TEST_VERBOSE", "maybe", 1);
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program"}), Equals("test-program: environment variable 'CPPARSE_TEST_VERBOSE' for 'verbose' must be a boolean"));
+		REQUIRE_THROWS_WITH(level.env("OTHER"), Contains("already reads environment variable 'CPPARSE_TEST_LEVEL'"));
+		REQUIRE_THROWS_WITH(parser.add_optional("--other").env("CPPARSE_TEST_JOBS"), Contains("is already read by another argument"));
+		REQUIRE_THROWS_WITH(parser.add_optional("--bad").env("A=B"), Contains("invalid environment variable name"));
+		REQUIRE(help_contains(parser, "[env: CPPARSE_TEST_JOBS]"));
+	}
+
+	::unsetenv("CPPARSE_TEST_JOBS");
+	::unsetenv("CPPARSE_TEST_VERBOSE");
+	::unsetenv("CPPARSE_TEST_PATH");
+}
+#endif /* defined(__unix__) || defined(__APPLE__) */
+
+TEST_CASE("Argument_Parser status reporting") {
+	Argument_Parser parser{Argument_Parser::Options{}.allow_abbrev(true)};
+	parser.add_positional("pos");
+	parser.add_optional("-c", "--count", Opt_Type::SINGLE);
+	parser.add_optional("--verbose", Opt_Type::FLAG);
+	parser.add_optional("--version", Opt_Type::FLAG);
+	std::vector<int> numbers;
+	parser.add_optional("-n", "--number", Opt_Type::APPEND).on_value<int>([&numbers](int value) { numbers.push_back(value); });
+
+	const auto try_parse_args = [&parser](std::vector<const char *> args) {
+		int argc = args.size();
+		auto argv = args.data();
+		const auto status = parser.try_parse_args(argc, argv);
+		REQUIRE(argc == static_cast<int>(args.size()));
+		return status;
+	};
+
+	SECTION("Successful parse") {
+		std::vector<const char *> args{"test-program", "-c", "3", "value", "extra"};
+		int argc = args.size();
+		auto argv = args.data();
+		const auto status = parser.try_parse_args(argc, argv);
+		REQUIRE(status.ok());
+		REQUIRE(status.code() == Parse_Errc::NONE);
+		REQUIRE(status.message().empty());
+		REQUIRE(argc == 2);
+		int value{0};
+		REQUIRE(parser.try_arg("count", value).ok());
+		REQUIRE(value == 3);
+		int missing{7};
+		REQUIRE(parser.try_arg_at("number", 0, missing).ok());
+		REQUIRE(missing == 7);
+	}
+
+	SECTION("Error codes") {
+		auto status = try_parse_args({"test-program", "-x"});
+		REQUIRE(status.code() == Parse_Errc::INVALID_FLAG);
+		REQUIRE(status.arg_index() == 1);
+		REQUIRE(status.token() == "-x");
+		REQUIRE(status.message() == "test-program: invalid flag '-x', pass --help to display possible options");
+
+		status = try_parse_args({"test-program", "value", "--cont", "2"});
+		REQUIRE(status.code() == Parse_Errc::INVALID_OPTION);
+		REQUIRE(status.arg_index() == 2);
+		REQUIRE(status.token() == "cont");
+		REQUIRE(status.message() == "test-program: invalid option 'cont' (did you mean '--count'?), pass --help to display possible options");
+
+		status = try_parse_args({"test-program", "--ver"});
+		REQUIRE(status.code() == Parse_Errc::AMBIGUOUS_OPTION);
+		REQUIRE(status.message() == "test-program: ambiguous option 'ver' could match --verbose, --version");
+
+		status = try_parse_args({"test-program", "value", "-c"});
+		REQUIRE(status.code() == Parse_Errc::MISSING_VALUE);
+		REQUIRE(status.argument() == 1);
+		REQUIRE(status.message() == "test-program: 'count' requires a value");
+
+		status = try_parse_args({"test-program", "value", "-c", "1", "-c", "2"});
+		REQUIRE(status.code() == Parse_Errc::REPEATED_ARGUMENT);
+		REQUIRE(status.arg_index() == 4);
+
+		status = try_parse_args({"test-program", "-c", "1"});
+		REQUIRE(status.code() == Parse_Errc::MISSING_POSITIONAL);
+		REQUIRE(status.arg_index() == -1);
+		REQUIRE(status.argument() == 0);
+		REQUIRE(status.message() == "test-program: requires positional argument 'pos'");
+		REQUIRE(!parser.has_arg("count"));
+
+		status = try_parse_args({"test-program", "-n", "1", "-n", "one", "value"});
+		REQUIRE(status.code() == Parse_Errc::CONVERSION);
+		REQUIRE(status.arg_index() == 4);
+		REQUIRE(status.message() == "test-program: 'number' must be of integral type");
+		REQUIRE(!parser.has_arg("number"));
+	}
+
+	SECTION("Messages match the thrown errors") {
+		const std::vector<std::vector<const char *>> failures{
+			{"test-program", "-x"},
+			{"test-program", "--bogus"},
+			{"test-program", "--ver"},
+			{"test-program", "value", "-c"},
+			{"test-program", "-c", "1", "--count", "2", "value"},
+			{"test-program"},
+			{"test-program", "-n", "one", "value"}
+		};
+		for (const auto &args : failures) {
+			const auto status = try_parse_args(args);
+			REQUIRE(!status);
+			REQUIRE_THROWS_WITH(invoke_parse_args(parser, args), Equals(status.message()));
+		}
+	}
+
+	SECTION("Conversion status") {
+		invoke_parse_args(parser, {"test-program", "-c", "abc", "value"});
+		int value{5};
+		const auto status = parser.try_arg("count", value);
+		REQUIRE(status.code() == Parse_Errc::CONVERSION);
+		REQUIRE(status.argument() == 1);
+		REQUIRE(value == 5);
+		REQUIRE(status.message() == "test-program: 'count' must be of integral type");
+		REQUIRE_THROWS_WITH(parser.arg<int>("count"), Equals(status.message()));
+		REQUIRE_THROWS_WITH(parser.try_arg("bogus", value), Contains("no argument by the name 'bogus'"));
+	}
+
+	SECTION("Batch status") {
+		const std::vector<std::vector<const char *>> lines{
+			{"test-program", "value"},
+			{"test-program", "-x", "value"}
+		};
+		const auto results = parser.parse_batch(lines, 1);
+		REQUIRE(results[0].ok());
+		REQUIRE(results[0].status().ok());
+		REQUIRE(!results[1].ok());
+		REQUIRE(results[1].status().code() == Parse_Errc::INVALID_FLAG);
+		REQUIRE(results[1].status().arg_index() == 1);
+		REQUIRE(results[1].error() == "test-program: invalid flag '-x', pass --help to display possible options");
+	}
+}
+
+TEST_CASE("Argument_Parser choices and ranges") {
+	Argument_Parser parser{};
+	auto &level = parser.add_optional("-l", "--level", Opt_Type::SINGLE).choices({"debug", "info", "warn"});
+	const std::vector<std::string> format_names{"json", "text"};
+	parser.add_optional("--format", Opt_Type::APPEND).delimiter(',').choices(format_names);
+	auto &threads = parser.add_optional("-t", "--threads", Opt_Type::SINGLE).range(1, 256);
+	parser.add_optional("--ratio", Opt_Type::SINGLE).range(0.0, 1.0);
+
+	const auto try_parse_args = [&parser](std::vector<const char *> args) {
+		int argc = args.size();
+		auto argv = args.data();
+		return parser.try_parse_args(argc, argv);
+	};
+
+	SECTION("Valid values") {
+		invoke_parse_args(parser, {"test-program", "-l", "warn", "--format", "text,json", "-t", "256", "--ratio", "0.5"});
+		REQUIRE(level.as_type<std::string>() == "warn");
+		REQUIRE(level.choice() == 2);
+		REQUIRE(parser.choice("level") == 2);
+		REQUIRE(parser.choice_at("format", 0) == 1);
+		REQUIRE(parser.choice_at("format", 1) == 0);
+		REQUIRE(threads.as_type<int>() == 256);
+		REQUIRE(parser.arg<double>("ratio") == 0.5);
+
+		invoke_parse_args(parser, {"test-program", "-t", "1"});
+		REQUIRE(parser.choice("level", 1) == 1);
+		REQUIRE_THROWS_AS(parser.choice("level"), std::out_of_range);
+		REQUIRE_THROWS_WITH(parser.choice("threads"), Contains("'threads' does not have choices"));
+		REQUIRE_THROWS_WITH(parser.choice("threads", 0), Contains("'threads' does not have choices"));
+	}
+
+	SECTION("Invalid values") {
+		auto status = try_parse_args({"test-program", "--level", "trace"});
+		REQUIRE(status.code() == Parse_Errc::INVALID_CHOICE);
+		REQUIRE(status.arg_index() == 2);
+		REQUIRE(status.token() == "trace");
+		REQUIRE(status.message() == "test-program: invalid choice 'trace' for 'level' (choose from debug, info, warn)");
+
+		status = try_parse_args({"test-program", "--format", "json,xml"});
+		REQUIRE(status.code() == Parse_Errc::INVALID_CHOICE);
+		REQUIRE(status.token() == "xml");
+
+		status = try_parse_args({"test-program", "-t", "0"});
+		REQUIRE(status.code() == Parse_Errc::OUT_OF_RANGE);
+		REQUIRE(status.token() == "0");
+		REQUIRE(status.message() == "test-program: 'threads' must be in range [1,256]");
+
+		status = try_parse_args({"test-program", "-t", "many"});
+		REQUIRE(status.code() == Parse_Errc::CONVERSION);
+		REQUIRE(status.message() == "test-program: 'threads' must be of integral type");
+
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--ratio", "1.5"}), Equals("test-program: 'ratio' must be in range [0,1]"));
+		REQUIRE(!level.exists());
+	}
+
+	SECTION("Help and completion") {
+		REQUIRE(help_contains(parser, "-l, --level {debug,info,warn}"));
+		REQUIRE(help_contains(parser, "--format {json,text}[,...]"));
+		const auto complete = [&parser](std::vector<const char *> words) {
+			std::stringstream ss;
+			parser.print_completions(words.size(), words.data(), ss);
+			return ss.str();
+		};
+		REQUIRE(complete({"--level", ""}) == "debug\ninfo\nwarn\n");
+		REQUIRE(complete({"-l", "in"}) == "info\n");
+		REQUIRE(complete({"-t", ""}).empty());
+	}
+
+	SECTION("Definition errors") {
+		auto &flag = parser.add_optional("--flag", Opt_Type::FLAG);
+		REQUIRE_THROWS_WITH(flag.choices({"a"}), Contains("flag argument 'flag' cannot have choices"));
+		REQUIRE_THROWS_WITH(flag.range(0, 1), Contains("flag argument 'flag' cannot have a range"));
+		auto &other = parser.add_optional("--other");
+		REQUIRE_THROWS_WITH(other.choices(std::vector<std::string>{}), Contains("no choices given for 'other'"));
+		REQUIRE_THROWS_WITH(other.choices({"a", "b", "a"}), Contains("duplicate choice 'a' for 'other'"));
+		REQUIRE_THROWS_WITH(other.range(2, 1), Contains("invalid range for 'other'"));
+	}
+}
+
+namespace {
+
+	/** Host and port pair converted from "host:port" */
+	struct Endpoint {
+		String_View host;
+		unsigned short port{0};
+	};
+
+	/** Integer that counts its live instances */
+	struct Counted {
+		static int live;
+
+		Counted() noexcept { ++live; }
+		Counted(const Counted &other) noexcept : value{other.value} { ++live; }
+		~Counted() { --live; }
+		Counted &operator=(const Counted &) = default;
+
+		int value{0};
+	};
+
+	int Counted::live{0};
+
+}
+
+namespace cpparse {
+
+	template<>
+	struct converter<Counted> {
+		static Convert_Error convert(String_View value, Counted &out) noexcept {
+			return convert_value<int>(value, out.value);
+		}
+	};
+
+	template<>
+	struct converter<Endpoint> {
+		static Convert_Error convert(String_View value, Endpoint &out) noexcept {
+			const auto colon = std::find(value.data(), value.data() + value.size(), ':');
+			if (colon == value.data() || colon == value.data() + value.size())
+				return Convert_Error::INVALID;
+			unsigned short port;
+			const auto err = convert_value<unsigned short>(String_View{colon + 1, static_cast<std::size_t>(value.data() + value.size() - colon - 1)}, port);
+			if (err != Convert_Error::NONE)
+				return err;
+			out.host = String_View{value.data(), static_cast<std::size_t>(colon - value.data())};
+			out.port = port;
+			return Convert_Error::NONE;
+		}
+
+		static std::string error(String_View name, Convert_Error) {
+			return "'" + to_string(name) + "' must be given as host:port";
+		}
+	};
+
+}
+
+TEST_CASE("Argument_Parser converters") {
+	Argument_Parser parser{};
+	parser.add_optional("--timeout", Opt_Type::SINGLE);
+	parser.add_optional("--cache-size", Opt_Type::SINGLE);
+	std::vector<Endpoint> peers;
+	parser.add_optional("--peer", Opt_Type::APPEND).on_value<Endpoint>([&peers](Endpoint peer) { peers.push_back(peer); });
+
+	SECTION("Values") {
+		invoke_parse_args(parser, {"test-program", "--timeout", "1m30s", "--cache-size", "64M", "--peer", "db:5432", "--peer", "cache:6379"});
+		REQUIRE(parser.arg<std::chrono::seconds>("timeout") == std::chrono::seconds{90});
+		REQUIRE(parser.arg<std::chrono::milliseconds>("timeout").count() == 90000);
+		REQUIRE(parser.arg<Byte_Size>("cache-size") == 64ull << 20);
+		REQUIRE(peers.size() == 2);
+		REQUIRE(peers[1].host == "cache");
+		REQUIRE(peers[1].port == 6379);
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE(parser.arg<Byte_Size>("cache-size", Byte_Size{4096}) == 4096);
+	}
+
+	SECTION("Errors") {
+		invoke_parse_args(parser, {"test-program", "--timeout", "1500ms", "--cache-size", "lots"});
+		REQUIRE_THROWS_WITH(parser.arg<std::chrono::seconds>("timeout"), Equals("test-program: 'timeout' must be a duration such as 1h30m or 90s, in multiples of 1s"));
+		REQUIRE_THROWS_WITH(parser.arg<Byte_Size>("cache-size"), Equals("test-program: 'cache-size' must be a size such as 4096, 512K or 4G"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--peer", "db"}), Equals("test-program: 'peer' must be given as host:port"));
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", "--peer", "db:99999"}), Equals("test-program: 'peer' must be given as host:port"));
+	}
+
+	SECTION("Only converted values are constructed") {
+		auto &count = parser.add_optional("--count", Opt_Type::APPEND);
+		invoke_parse_args(parser, {"test-program", "--count", "1", "--count", "x", "--count", "3"});
+		REQUIRE(count.as_type_at<Counted>(2).value == 3);
+		REQUIRE(Counted::live == 2);
+		REQUIRE(count.as_type_at<Counted>(0).value == 1);
+		REQUIRE_THROWS(count.as_type_at<Counted>(1));
+		REQUIRE_THROWS(count.as_type_all<Counted>());
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE(Counted::live == 0);
+	}
+}
+
+TEST_CASE("Argument_Parser configuration files") {
+	Argument_Parser parser{};
+	auto &define = parser.add_optional("-D", "--define", Opt_Type::APPEND);
+	auto &output = parser.add_optional("-o", "--output", Opt_Type::SINGLE);
+	auto &verbose = parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+	auto &level = parser.add_optional("--log-level", Opt_Type::SINGLE);
+	parser.add_positional("input");
+
+	const auto parse_config = [&parser](const std::string &contents) {
+		std::istringstream in{contents};
+		parser.parse_config(in, "test.conf");
+	};
+
+	SECTION("Entries") {
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		parse_config("# comment\n\n  output = \"out file.txt\" \r\n; comment\ndefine=a\ndefine = b\nverbose\n[log]\nlevel = 3\n");
+		REQUIRE(output.as_type<std::string>() == "out file.txt");
+		REQUIRE(define.as_type_all<std::string>() == std::vector<std::string>{"a", "b"});
+		REQUIRE(verbose.as_type<bool>());
+		REQUIRE(level.as_type<int>() == 3);
+		REQUIRE(parser.arg<std::string>("input") == "in.txt");
+	}
+
+	SECTION("Command line takes precedence") {
+		invoke_parse_args(parser, {"test-program", "-o", "cli.txt", "-D", "x", "in.txt"});
+		REQUIRE(parser.args_ref<std::string>("define").size() == 1);
+		parse_config("output = conf.txt\ndefine = y\nlog-level = 2\n");
+		REQUIRE(output.as_type<std::string>() == "cli.txt");
+		REQUIRE(define.as_type_all<std::string>() == std::vector<std::string>{"x"});
+		REQUIRE(level.as_type<int>() == 2);
+		parse_config("log-level = 5\n");
+		REQUIRE(level.as_type<int>() == 2);
+	}
+
+	SECTION("Cached values are refreshed") {
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		REQUIRE(parser.args_ref<std::string>("define").empty());
+		parse_config("define = a\n");
+		REQUIRE(parser.args_ref<std::string>("define").size() == 1);
+	}
+
+	SECTION("Errors") {
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		REQUIRE_THROWS_WITH(parse_config("\nbogus = 1\n"), Equals("test-program: test.conf:2: invalid option 'bogus'"));
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		REQUIRE_THROWS_WITH(parse_config("input = 1\n"), EndsWith("invalid option 'input'"));
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		REQUIRE_THROWS_WITH(parse_config("output\n"), EndsWith("test.conf:1: 'output' requires a value"));
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		REQUIRE_THROWS_WITH(parse_config("output = a\noutput = b\n"), EndsWith("test.conf:2: 'output' should only be specified once"));
+		invoke_parse_args(parser, {"test-program", "in.txt"});
+		REQUIRE_THROWS_WITH(parse_config("[log\n"), EndsWith("test.conf:1: invalid line '[log'"));
+		REQUIRE_THROWS_WITH(parse_config("= 1\n"), EndsWith("invalid line '= 1'"));
+		REQUIRE(!output.exists());
+		REQUIRE_THROWS_WITH(parser.parse_config_file("/nonexistent/cparseparse.conf"), EndsWith("cannot open configuration file '/nonexistent/cparseparse.conf'"));
+	}
+
+	SECTION("Results from parse()") {
+		const std::vector<const char *> args{"test-program", "-o", "cli.txt", "in.txt"};
+		auto filled = parser.parse(args.size(), args.data());
+		std::istringstream in{"output = conf.txt\nlog-level = 1\n"};
+		parser.parse_config(in, filled);
+		REQUIRE(filled.arg<std::string>("output") == "cli.txt");
+		REQUIRE(filled.arg<int>("log-level") == 1);
+		REQUIRE(!parser.has_arg("log-level"));
+	}
+}
+
+TEST_CASE("Argument_Parser snapshots") {
+	const auto define_args = [](Argument_Parser &parser) {
+		parser.add_optional("-D", "--define", Opt_Type::APPEND);
+		parser.add_optional("-o", "--output", Opt_Type::SINGLE);
+		parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+		parser.add_positional("input");
+	};
+	Argument_Parser parser{};
+	define_args(parser);
+	invoke_parse_args(parser, {"test-program", "-D", "a", "-v", "-D", "b", "-o", "out.txt", "in.txt", "extra"});
+	const auto snapshot = parser.snapshot();
+
+	SECTION("Round trip") {
+		Argument_Parser worker{};
+		define_args(worker);
+		worker.load_snapshot(snapshot.data(), snapshot.size());
+		REQUIRE(worker.args<std::string>("define") == std::vector<std::string>{"a", "b"});
+		REQUIRE(worker.arg<std::string>("output") == "out.txt");
+		REQUIRE(worker.has_arg("verbose"));
+		REQUIRE(worker.arg<std::string>("input") == "in.txt");
+		REQUIRE(worker.arg_count("define") == 2);
+
+		Parse_Result result{};
+		worker.load_snapshot(snapshot.data(), snapshot.size(), result);
+		REQUIRE(result.script_name() == "test-program");
+		REQUIRE(result.extra_count() == 1);
+		REQUIRE(std::string{result.extra_args()[0]} == "extra");
+		REQUIRE(result.snapshot() == snapshot);
+	}
+
+	SECTION("Values refer to the snapshot") {
+		Argument_Parser worker{};
+		define_args(worker);
+		const auto result = [&]() {
+			Parse_Result loaded{};
+			worker.load_snapshot(snapshot.data(), snapshot.size(), loaded);
+			return loaded;
+		}();
+		const auto input = result.arg<String_View>("input");
+		REQUIRE(input.data() >= snapshot.data());
+		REQUIRE(input.data() < snapshot.data() + snapshot.size());
+	}
+
+	SECTION("Errors") {
+		Argument_Parser other{};
+		other.add_optional("-o", "--output", Opt_Type::SINGLE);
+		other.add_positional("input");
+		REQUIRE_THROWS_WITH(other.load_snapshot(snapshot.data(), snapshot.size()), Contains("does not match the argument definitions"));
+		REQUIRE_THROWS_WITH(parser.load_snapshot(snapshot.data(), snapshot.size() - 1), Contains("invalid parse snapshot"));
+		REQUIRE_THROWS_WITH(parser.load_snapshot(snapshot.data(), 2), Contains("invalid parse snapshot"));
+		auto corrupt = snapshot;
+		corrupt[4] = 2;
+		REQUIRE_THROWS_WITH(parser.load_snapshot(corrupt.data(), corrupt.size()), Contains("invalid parse snapshot"));
+		REQUIRE(!parser.has_arg("output"));
+	}
+}
+
+#ifdef CPPARSE_INSTRUMENTATION
+namespace {
+
+	class Recording_Observer : public Parse_Observer {
+	public:
+		std::vector<Parse_Phase> phases;
+		Parse_Counters counters;
+		std::size_t parses{0};
+		std::size_t conversions{0};
+
+		void on_phase(Parse_Phase phase, std::chrono::nanoseconds elapsed) noexcept override {
+			phases.push_back(phase);
+			REQUIRE(elapsed.count() >= 0);
+		}
+
+		void on_parse(const Parse_Counters &parse_counters) noexcept override {
+			counters = parse_counters;
+			++parses;
+		}
+
+		void on_conversion(String_View, std::size_t count, std::chrono::nanoseconds) noexcept override {
+			conversions += count;
+		}
+	};
+
+}
+
+TEST_CASE("Argument_Parser instrumentation") {
+	Recording_Observer observer;
+	Argument_Parser parser{Argument_Parser::Options{}.observer(&observer)};
+	parser.add_optional("-a", "--append", Opt_Type::APPEND);
+	parser.add_optional("-v", "--verbose", Opt_Type::FLAG);
+	parser.add_positional("pos");
+
+	invoke_parse_args(parser, {"test-program", "-a", "12", "-a", "345", "-v", "pos"});
+	REQUIRE(observer.phases == std::vector<Parse_Phase>{Parse_Phase::ASSIGN_POSITIONALS, Parse_Phase::MATCH_ARGS});
+	REQUIRE(observer.parses == 1);
+	REQUIRE(observer.counters.tokens == 4);
+	REQUIRE(observer.counters.values == 4);
+	REQUIRE(observer.counters.bytes_copied == std::string{"test-program"}.size() + 2 + 3 + 3);
+
+	REQUIRE(parser.args<int>("append") == std::vector<int>{12, 345});
+	REQUIRE(observer.conversions == 2);
+	parser.args_ref<int>("append");
+	REQUIRE(observer.conversions == 2);
+
+	REQUIRE_THROWS(invoke_parse_args(parser, {"test-program"}));
+	REQUIRE(observer.parses == 1);
+	REQUIRE(observer.phases.back() == Parse_Phase::MATCH_ARGS);
+
+	/* Values converted by a range check are not converted again */
+	Argument_Parser ranged{Argument_Parser::Options{}.observer(&observer)};
+	ranged.add_optional("--threads", Opt_Type::APPEND).range(1, 8);
+	observer.conversions = 0;
+	invoke_parse_args(ranged, {"test-program", "--threads", "4", "--threads", "8"});
+	REQUIRE(observer.conversions == 2);
+	REQUIRE(ranged.args<int>("threads") == std::vector<int>{4, 8});
+	REQUIRE(ranged.arg_at<int>("threads", 1) == 8);
+	REQUIRE(observer.conversions == 2);
+	REQUIRE(ranged.args<long>("threads") == std::vector<long>{4, 8});
+	REQUIRE(observer.conversions == 4);
+}
+#endif /* CPPARSE_INSTRUMENTATION */
+
+#ifdef CPPARSE_HAS_MMAP
+namespace {
+
+	/** Temporary file that is removed on destruction */
+	class Temp_File {
+	public:
+		explicit Temp_File(const std::string &contents) {
+			char path[] = "/tmp/cparseparse-test-XXXXXX";
+			const int fd = ::mkstemp(path);
+			REQUIRE(fd >= 0);
+			REQUIRE(::write(fd, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size()));
+			::close(fd);
+			m_path = path;
+			m_arg = "@" + m_path;
+		}
+
+		~Temp_File() {
+			::unlink(m_path.c_str());
+		}
+
+		void rewrite(const std::string &contents) const {
+			std::FILE *file = std::fopen(m_path.c_str(), "w");
+			REQUIRE(file);
+			std::fputs(contents.c_str(), file);
+			std::fclose(file);
+		}
+
+		const char *arg() const noexcept {
+			return m_arg.c_str();
+		}
+
+		const std::string &path() const noexcept {
+			return m_path;
+		}
+
+	private:
+		std::string m_path;
+		std::string m_arg;
+	};
+
+#ifdef __linux__
+	/**
+	 * @return true if @a ptr points into a mapping of the file at @a path
+	 */
+	bool in_file_mapping(const char *ptr, const std::string &path) {
+		std::FILE *maps = std::fopen("/proc/self/maps", "r");
+		REQUIRE(maps);
+		const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+		char line[4096];
+		bool found{false};
+		while (!found && std::fgets(line, sizeof(line), maps)) {
+			unsigned long start, end;
+			int path_pos{0};
+			if (std::sscanf(line, "%lx-%lx %*s %*s %*s %*s %n", &start, &end, &path_pos) != 2)
+				continue;
+			const std::string mapped{line + path_pos, std::strcspn(line + path_pos, "\n")};
+			found = mapped == path && start <= addr && addr < end;
+		}
+		std::fclose(maps);
+		return found;
+	}
+#endif /* __linux__ */
+
+}
+
+TEST_CASE("Argument_Parser response files") {
+	Argument_Parser parser{Argument_Parser::Options{}.response_files(true)};
+	auto &define = parser.add_optional("-D", "--define", Opt_Type::APPEND);
+	auto &output = parser.add_optional("-o", "--output", Opt_Type::SINGLE);
+	auto &input = parser.add_positional("input");
+
+	SECTION("Quoting and escapes") {
+		Temp_File file{"-D 'a b' -D \"c \\\" d\"\n\t-D e\\ f -o out.txt\n"};
+		invoke_parse_args(parser, {"test-program", file.arg(), "in.txt"});
+		REQUIRE(define.as_type_at<std::string>(0) == "a b");
+		REQUIRE(define.as_type_at<std::string>(1) == "c \" d");
+		REQUIRE(define.as_type_at<std::string>(2) == "e f");
+		REQUIRE(output.as_type<std::string>() == "out.txt");
+		REQUIRE(input.as_type<std::string>() == "in.txt");
+	}
+
+	SECTION("Nested files") {
+		Temp_File inner{"-o out.txt"};
+		Temp_File outer{"-D x " + std::string{inner.arg()} + " in.txt"};
+		invoke_parse_args(parser, {"test-program", outer.arg(), "-D", "y"});
+		REQUIRE(define.count() == 2);
+		REQUIRE(define.as_type_at<std::string>(1) == "y");
+		REQUIRE(output.as_type<std::string>() == "out.txt");
+		REQUIRE(input.as_type<std::string>() == "in.txt");
+	}
+
+	SECTION("Unreadable files are kept as arguments") {
+		invoke_parse_args(parser, {"test-program", "@/nonexistent/cparseparse-response-file"});
+		REQUIRE(input.as_type<std::string>() == "@/nonexistent/cparseparse-response-file");
+		invoke_parse_args(parser, {"test-program", "@"});
+		REQUIRE(input.as_type<std::string>() == "@");
+	}
+
+	SECTION("Recursive files") {
+		Temp_File file{""};
+		file.rewrite(file.arg());
+		REQUIRE_THROWS_WITH(invoke_parse_args(parser, {"test-program", file.arg()}), StartsWith("test-program: response file '") && EndsWith("' is nested too deeply"));
+		REQUIRE(!define.exists());
+	}
+
+	SECTION("Extra arguments beyond argc") {
+		Temp_File file{"in.txt x1 x2 x3"};
+		std::vector<const char *> args{"test-program", file.arg()};
+		int argc = args.size();
+		auto argv = args.data();
+		parser.parse_args(argc, argv);
+		REQUIRE(argc == 4);
+		REQUIRE(std::string{argv[0]} == "test-program");
+		REQUIRE(std::string{argv[1]} == "x1");
+		REQUIRE(std::string{argv[3]} == "x3");
+		REQUIRE(args[1] == file.arg());
+	}
+
+	SECTION("Token ending at a page boundary") {
+		std::string contents{"-o o"};
+		contents.resize(4096 - 6, ' ');
+		contents += "in.txt";
+		REQUIRE(contents.size() == 4096);
+		Temp_File file{contents};
+		invoke_parse_args(parser, {"test-program", file.arg()});
+		REQUIRE(output.as_type<std::string>() == "o");
+		REQUIRE(input.as_type<std::string>() == "in.txt");
+	}
+
+	SECTION("Errors report the position of the file argument") {
+		Temp_File inner{"-o out.txt --bogus"};
+		Temp_File outer{"-D x  " + std::string{inner.arg()}};
+		std::vector<const char *> args{"test-program", "in.txt", "-D", "y", outer.arg()};
+		int argc = args.size();
+		auto argv = args.data();
+		const auto status = parser.try_parse_args(argc, argv);
+		REQUIRE(status.code() == Parse_Errc::INVALID_OPTION);
+		REQUIRE(status.arg_index() == 4);
+		REQUIRE(status.file_offset() == 11);
+		REQUIRE(status.token() == "bogus");
+
+		Temp_File file{"-o"};
+		args = {"test-program", "in.txt", file.arg()};
+		argc = args.size();
+		argv = args.data();
+		const auto missing = parser.try_parse_args(argc, argv);
+		REQUIRE(missing.code() == Parse_Errc::MISSING_VALUE);
+		REQUIRE(missing.arg_index() == 2);
+		REQUIRE(missing.file_offset() == 0);
+
+		args = {"test-program", "-x"};
+		argc = args.size();
+		argv = args.data();
+		const auto plain = parser.try_parse_args(argc, argv);
+		REQUIRE(plain.arg_index() == 1);
+		const auto npos = Parse_Status::NPOS;
+		REQUIRE(plain.file_offset() == npos);
+	}
+
+	SECTION("Plain values refer into the file mapping") {
+		Temp_File file{"-o out.txt -D 'a b' in.txt x1\n"};
+		std::vector<const char *> args{"test-program", file.arg()};
+		int argc = args.size();
+		auto argv = args.data();
+		parser.parse_args(argc, argv);
+		const auto out = output.as_type<String_View>();
+		const auto in = input.as_type<String_View>();
+		const auto quoted = define.as_type_at<String_View>(0);
+		REQUIRE(out == "out.txt");
+		REQUIRE(out.data()[out.size()] == ' ');
+		REQUIRE(in.data() - out.data() == 17);
+		REQUIRE(quoted == "a b");
+		REQUIRE(quoted.data()[quoted.size()] == '\0');
+		REQUIRE(argc == 2);
+		REQUIRE(std::string{argv[1]} == "x1");
+#ifdef __linux__
+		REQUIRE(in_file_mapping(out.data(), file.path()));
+		REQUIRE(in_file_mapping(in.data(), file.path()));
+		REQUIRE(!in_file_mapping(quoted.data(), file.path()));
+		REQUIRE(!in_file_mapping(argv[1], file.path()));
+#endif /* __linux__ */
+	}
+
+	SECTION("Values outlive argv") {
+		Argument_Parser ref_parser{Argument_Parser::Options{}.copy_args(false).response_files(true)};
+		auto &ref_input = ref_parser.add_positional("input");
+		{
+			Temp_File file{"from-file"};
+			std::string arg{file.arg()};
+			invoke_parse_args(ref_parser, {"test-program", arg.c_str()});
+			arg.assign(arg.size(), 'x');
+		}
+		REQUIRE(ref_input.as_type<std::string>() == "from-file");
+	}
+
+	SECTION("Disabled by default") {
+		Argument_Parser plain_parser{};
+		auto &plain_input = plain_parser.add_positional("input");
+		Temp_File file{"from-file"};
+		invoke_parse_args(plain_parser, {"test-program", file.arg()});
+		REQUIRE(plain_input.as_type<std::string>() == file.arg());
+	}
+}
+
+TEST_CASE("Config_Reloader") {
+	Argument_Parser parser{};
+	parser.add_optional("-o", "--output", Opt_Type::SINGLE);
+	parser.add_optional("-D", "--define", Opt_Type::APPEND);
+	parser.add_optional("--threads", Opt_Type::SINGLE);
+	parser.add_optional("--verbose", Opt_Type::FLAG);
+	Temp_File base{"threads = 4\ndefine = a\n"};
+	Temp_File local{"verbose\n"};
+	const std::vector<const char *> args{"test-program", "-o", "out.txt"};
+	Config_Reloader reloader{parser, static_cast<int>(args.size()), args.data(), {local.path(), base.path()}};
+
+	SECTION("Initial values") {
+		const auto result = reloader.current();
+		REQUIRE(result->arg<std::string>("output") == "out.txt");
+		REQUIRE(result->arg<int>("threads") == 4);
+		REQUIRE(result->has_arg("verbose"));
+		REQUIRE(reloader.reload().empty());
+	}
+
+	SECTION("Changed values") {
+		const auto previous = reloader.current();
+		base.rewrite("threads = 8\ndefine = a\n");
+		local.rewrite("threads = 2\nverbose\n");
+		REQUIRE(reloader.reload() == std::vector<std::string>{"threads"});
+		REQUIRE(reloader.current()->arg<int>("threads") == 2);
+		REQUIRE(previous->arg<int>("threads") == 4);
+
+		local.rewrite("");
+		base.rewrite("threads = 8\ndefine = a\ndefine = b\noutput = other.txt\n");
+		REQUIRE(reloader.reload() == std::vector<std::string>{"define", "threads", "verbose"});
+		REQUIRE(reloader.current()->arg<std::string>("output") == "out.txt");
+		REQUIRE(reloader.current()->arg_count("define") == 2);
+	}
+
+	SECTION("Unchanged contents") {
+		const auto previous = reloader.current();
+		base.rewrite("threads = 4\ndefine = a\n");
+		REQUIRE(reloader.reload().empty());
+		REQUIRE(reloader.current() == previous);
+	}
+
+	SECTION("Errors keep the current result") {
+		const auto previous = reloader.current();
+		base.rewrite("bogus = 1\n");
+		REQUIRE_THROWS_WITH(reloader.reload(), EndsWith("invalid option 'bogus'"));
+		REQUIRE(reloader.current() == previous);
+		base.rewrite("threads = 6\ndefine = a\n");
+		REQUIRE(reloader.reload() == std::vector<std::string>{"threads"});
+		REQUIRE_THROWS_WITH((Config_Reloader{parser, static_cast<int>(args.size()), args.data(), {"/nonexistent/cparseparse.conf"}}), Equals("test-program: cannot open configuration file '/nonexistent/cparseparse.conf'"));
+	}
+}
+#endif /* CPPARSE_HAS_MMAP */
+
+#ifdef CPPARSE_HAS_PMR
+namespace {
+
+	class Counting_Resource : public std::pmr::memory_resource {
+	public:
+		std::size_t allocations{0};
+
+	private:
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) override {
+			std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+			return this == &other;
+		}
+	};
+
+}
+
+TEST_CASE("Argument_Parser memory resources") {
+	Counting_Resource schema, results;
+	Argument_Parser parser{Argument_Parser::Options{}.schema_resource(&schema).result_resource(&results)};
+	parser.add_optional("-a", "--append", Opt_Type::APPEND);
+	parser.add_positional("pos");
+	REQUIRE(schema.allocations > 0);
+
+	const auto schema_allocations = schema.allocations;
+	const auto result_allocations = results.allocations;
+	invoke_parse_args(parser, {"test-program", "-a", "1", "p", "-a", "2"});
+	REQUIRE(schema.allocations == schema_allocations);
+	REQUIRE(results.allocations > result_allocations);
+	const auto parse_allocations = results.allocations;
+	REQUIRE(parser.args<int>("append") == std::vector<int>{1, 2});
+	REQUIRE(parser.arg<std::string>("pos") == "p");
+	REQUIRE(results.allocations > parse_allocations);
+
+	SECTION("Arena") {
+		char buffer[16384];
+		std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+		Argument_Parser arena_parser{Argument_Parser::Options{}.schema_resource(&arena).result_resource(&arena)};
+		arena_parser.add_optional("-s", "--single", Opt_Type::SINGLE);
+		invoke_parse_args(arena_parser, {"test-program", "-s", "value"});
+		REQUIRE(arena_parser.arg<std::string>("single") == "value");
+	}
+
+	SECTION("Reuse") {
+		const auto warm_allocations = results.allocations;
+		for (int i = 0; i < 10; ++i)
+			invoke_parse_args(parser, {"test-program", "-a", "3", "q", "-a", "4"});
+		REQUIRE(results.allocations == warm_allocations);
+		REQUIRE(parser.arg<std::string>("pos") == "q");
+	}
+
+	SECTION("Move assignment") {
+		parser = Argument_Parser{};
+		invoke_parse_args(parser, {"test-program"});
+		REQUIRE_THROWS_WITH(parser.arg<int>("append"), EndsWith("no argument by the name 'append'"));
+	}
+}
+#endif /* CPPARSE_HAS_PMR */
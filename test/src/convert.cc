@@ -0,0 +1,189 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#include "cparseparse/converters.h"
+#include "cparseparse/util/convert.h"
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <clocale>
+#include <cstdint>
+#include <string>
+
+using namespace cpparse;
+
+template<class T>
+static Convert_Error convert(const char *value, T &out) {
+	return convert_value<T>(value, out);
+}
+
+TEST_CASE("convert_value() integers") {
+	int i{0};
+	REQUIRE(convert("42", i) == Convert_Error::NONE);
+	REQUIRE(i == 42);
+	REQUIRE(convert("  +7", i) == Convert_Error::NONE);
+	REQUIRE(i == 7);
+	REQUIRE(convert("-9.5", i) == Convert_Error::NONE);
+	REQUIRE(i == -9);
+	REQUIRE(convert("-2147483648", i) == Convert_Error::NONE);
+	REQUIRE(i == std::numeric_limits<int>::min());
+	REQUIRE(convert("2147483648", i) == Convert_Error::OUT_OF_RANGE);
+	REQUIRE(convert("abc", i) == Convert_Error::INVALID);
+	REQUIRE(convert("+-1", i) == Convert_Error::INVALID);
+	REQUIRE(convert("", i) == Convert_Error::INVALID);
+	REQUIRE(i == std::numeric_limits<int>::min());
+
+	std::uint8_t u8{0};
+	REQUIRE(convert("255", u8) == Convert_Error::NONE);
+	REQUIRE(u8 == 255);
+	REQUIRE(convert("256", u8) == Convert_Error::OUT_OF_RANGE);
+	REQUIRE(convert("-1", u8) == Convert_Error::OUT_OF_RANGE);
+
+	unsigned long long ull{0};
+	REQUIRE(convert("18446744073709551615", ull) == Convert_Error::NONE);
+	REQUIRE(ull == std::numeric_limits<unsigned long long>::max());
+	REQUIRE(convert("18446744073709551616", ull) == Convert_Error::OUT_OF_RANGE);
+}
+
+TEST_CASE("convert_value() floating point") {
+	double d{0};
+	REQUIRE(convert("-9.5", d) == Convert_Error::NONE);
+	REQUIRE(d == -9.5);
+	REQUIRE(convert("1e3", d) == Convert_Error::NONE);
+	REQUIRE(d == 1000);
+	REQUIRE(convert("1e999", d) == Convert_Error::OUT_OF_RANGE);
+	REQUIRE(convert("x1", d) == Convert_Error::INVALID);
+
+	float f{0};
+	REQUIRE(convert("0.25", f) == Convert_Error::NONE);
+	REQUIRE(f == 0.25f);
+	REQUIRE(convert("1e39", f) == Convert_Error::OUT_OF_RANGE);
+}
+
+TEST_CASE("convert_value() floating-point grammar") {
+	double d{0};
+	REQUIRE(convert("0x10", d) == Convert_Error::NONE);
+	REQUIRE(d == 0);
+	REQUIRE(convert(".5", d) == Convert_Error::NONE);
+	REQUIRE(d == 0.5);
+	REQUIRE(convert("-2.e1", d) == Convert_Error::NONE);
+	REQUIRE(d == -20);
+	REQUIRE(convert("7e", d) == Convert_Error::NONE);
+	REQUIRE(d == 7);
+	REQUIRE(convert("1,5", d) == Convert_Error::NONE);
+	REQUIRE(d == 1);
+	REQUIRE(convert("nan(1)", d) == Convert_Error::NONE);
+	REQUIRE(d != d);
+	REQUIRE(convert("-Infinity", d) == Convert_Error::OUT_OF_RANGE);
+	REQUIRE(convert(".", d) == Convert_Error::INVALID);
+	REQUIRE(convert("-", d) == Convert_Error::INVALID);
+	REQUIRE(convert("e5", d) == Convert_Error::INVALID);
+
+	/* The decimal point is '.' in every locale */
+	const std::string previous{std::setlocale(LC_NUMERIC, nullptr)};
+	if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8")) {
+		REQUIRE(convert("1.5", d) == Convert_Error::NONE);
+		REQUIRE(d == 1.5);
+		REQUIRE(convert("2,5", d) == Convert_Error::NONE);
+		REQUIRE(d == 2);
+		std::setlocale(LC_NUMERIC, previous.c_str());
+	}
+}
+
+TEST_CASE("convert_value() non-numeric") {
+	bool b{false};
+	REQUIRE(convert("yes", b) == Convert_Error::NONE);
+	REQUIRE(b);
+	REQUIRE(convert("1", b) == Convert_Error::INVALID);
+
+	char c{0};
+	REQUIRE(convert("z", c) == Convert_Error::NONE);
+	REQUIRE(c == 'z');
+	REQUIRE(convert("zz", c) == Convert_Error::INVALID);
+
+	std::string s;
+	REQUIRE(convert("abc", s) == Convert_Error::NONE);
+	REQUIRE(s == "abc");
+}
+
+TEST_CASE("convert_value() durations") {
+	std::chrono::milliseconds ms{0};
+	REQUIRE(convert("500ms", ms) == Convert_Error::NONE);
+	REQUIRE(ms.count() == 500);
+	REQUIRE(convert("1h30m", ms) == Convert_Error::NONE);
+	REQUIRE(ms == std::chrono::minutes{90});
+	REQUIRE(convert("2d", ms) == Convert_Error::NONE);
+	REQUIRE(ms == std::chrono::hours{48});
+	REQUIRE(convert("1500us", ms) == Convert_Error::INVALID);
+	REQUIRE(convert("90", ms) == Convert_Error::INVALID);
+	REQUIRE(convert("s", ms) == Convert_Error::INVALID);
+	REQUIRE(convert("-1s", ms) == Convert_Error::INVALID);
+	REQUIRE(convert("", ms) == Convert_Error::INVALID);
+	REQUIRE(convert("300000d", ms) == Convert_Error::OUT_OF_RANGE);
+	REQUIRE(ms == std::chrono::hours{48});
+
+	std::chrono::duration<std::int16_t> short_seconds{0};
+	REQUIRE(convert("9h", short_seconds) == Convert_Error::NONE);
+	REQUIRE(convert("10h", short_seconds) == Convert_Error::OUT_OF_RANGE);
+
+	std::chrono::duration<double> seconds{0};
+	REQUIRE(convert("1500ms", seconds) == Convert_Error::NONE);
+	REQUIRE(seconds.count() == 1.5);
+}
+
+TEST_CASE("convert_value() byte sizes") {
+	Byte_Size size;
+	REQUIRE(convert("4096", size) == Convert_Error::NONE);
+	REQUIRE(size == 4096);
+	REQUIRE(convert("512K", size) == Convert_Error::NONE);
+	REQUIRE(size == 512 * 1024);
+	REQUIRE(convert("64MiB", size) == Convert_Error::NONE);
+	REQUIRE(size == 64ull << 20);
+	REQUIRE(convert("1.5g", size) == Convert_Error::NONE);
+	REQUIRE(size == 3ull << 29);
+	REQUIRE(convert("100B", size) == Convert_Error::NONE);
+	REQUIRE(size == 100);
+	REQUIRE(convert("15E", size) == Convert_Error::NONE);
+	REQUIRE(convert("16E", size) == Convert_Error::OUT_OF_RANGE);
+	REQUIRE(convert("4X", size) == Convert_Error::INVALID);
+	REQUIRE(convert("4GBs", size) == Convert_Error::INVALID);
+	REQUIRE(convert("1.G", size) == Convert_Error::INVALID);
+	REQUIRE(convert("G", size) == Convert_Error::INVALID);
+}
+
+namespace {
+
+	enum class Color { RED, GREEN };
+
+}
+
+namespace cpparse {
+
+	template<>
+	struct converter<Color> {
+		static Convert_Error convert(String_View value, Color &out) noexcept {
+			if (value == "red")
+				out = Color::RED;
+			else if (value == "green")
+				out = Color::GREEN;
+			else
+				return Convert_Error::INVALID;
+			return Convert_Error::NONE;
+		}
+	};
+
+}
+
+TEST_CASE("convert_value() user-defined converters") {
+	Color color{Color::RED};
+	REQUIRE(convert("green", color) == Convert_Error::NONE);
+	REQUIRE(color == Color::GREEN);
+	REQUIRE(convert("blue", color) == Convert_Error::INVALID);
+	REQUIRE(color == Color::GREEN);
+	REQUIRE(_convert_has_converter<Color>::value);
+	REQUIRE(!_convert_has_error<Color>::value);
+	REQUIRE(_convert_has_error<Byte_Size>::value);
+	REQUIRE(!_convert_has_converter<int>::value);
+}
@@ -0,0 +1,58 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#include "cparseparse/util/lexer.h"
+#include <catch2/catch.hpp>
+#include <string>
+
+using namespace cpparse;
+
+static std::string token_name(const Lexed_Token &token) {
+	return std::string(token.name, token.length);
+}
+
+TEST_CASE("lex_token()") {
+	SECTION("Flags") {
+		REQUIRE(lex_token("-a").kind == Token_Kind::FLAG);
+		REQUIRE(token_name(lex_token("-a")) == "a");
+		REQUIRE(lex_token("-_").kind == Token_Kind::FLAG);
+		REQUIRE(lex_token("-5").kind == Token_Kind::POSITIONAL);
+	}
+	SECTION("Long options") {
+		REQUIRE(lex_token("--opt0").kind == Token_Kind::OPTION);
+		REQUIRE(token_name(lex_token("--opt0")) == "opt0");
+		REQUIRE(token_name(lex_token("-opt0")) == "opt0");
+		REQUIRE(token_name(lex_token("--show-time")) == "show-time");
+		REQUIRE(lex_token("--a").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("---opt").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("--0pt").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("--opt=1").kind == Token_Kind::POSITIONAL);
+	}
+	SECTION("Clusters") {
+		REQUIRE(lex_token("-vvv").kind == Token_Kind::OPTION);
+		REQUIRE(lex_token("-ofile.txt").kind == Token_Kind::CLUSTER);
+		REQUIRE(token_name(lex_token("-ofile.txt")) == "ofile.txt");
+		REQUIRE(lex_token("-I/usr/include").kind == Token_Kind::CLUSTER);
+		REQUIRE(lex_token("--opt.txt").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("-5x").kind == Token_Kind::POSITIONAL);
+	}
+	SECTION("Separator and positionals") {
+		REQUIRE(lex_token("--").kind == Token_Kind::SEPARATOR);
+		REQUIRE(lex_token("-").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("-9.5").kind == Token_Kind::POSITIONAL);
+		REQUIRE(lex_token("abc").kind == Token_Kind::POSITIONAL);
+	}
+}
+
+TEST_CASE("lex_positional_name()") {
+	REQUIRE(lex_positional_name("pos0"));
+	REQUIRE(lex_positional_name("0pos"));
+	REQUIRE(lex_positional_name("my-pos_1"));
+	REQUIRE(!lex_positional_name(""));
+	REQUIRE(!lex_positional_name("-pos0"));
+	REQUIRE(!lex_positional_name("pos.0"));
+}
@@ -0,0 +1,110 @@
+/*
+ * Author: Matthew Rasa
+ * E-mail: matt@raztech.com
+ * GitHub: https://github.com/MatthewRasa
+ */
+
+#include "cparseparse/static-schema.h"
+#include <catch2/catch.hpp>
+
+#ifdef CPPARSE_HAS_STATIC_SCHEMA
+using namespace Catch::Matchers;
+using namespace cpparse;
+
+using Opt_Type = Optional_Info::Type;
+
+using Schema = Static_Schema<
+		Static_Optional<"verbose", 'v', Opt_Type::FLAG>,
+		Static_Optional<"jobs", 'j', Opt_Type::SINGLE, int>,
+		Static_Optional<"define", 'D', Opt_Type::APPEND>,
+		Static_Optional<"log-level">,
+		Static_Positional<"target", String_View>>;
+
+static Schema::Result parse(std::vector<const char *> args) {
+	return Schema::parse(args.size(), args.data());
+}
+
+TEST_CASE("Static_Schema parse()") {
+	SECTION("Typed fields") {
+		const auto result = parse({"test-program", "-v", "all", "--jobs", "4", "-D", "a", "--define", "b", "extra"});
+		REQUIRE(result.get<"verbose">());
+		REQUIRE(result.get<"jobs">() == 4);
+		REQUIRE(result.get<"define">() == std::vector<std::string>{"a", "b"});
+		REQUIRE(!result.get<"log-level">());
+		REQUIRE(result.get<"target">() == "all");
+		REQUIRE(result.script_name() == "test-program");
+		REQUIRE(result.extra_args().size() == 1);
+		REQUIRE(std::string{result.extra_args()[0]} == "extra");
+	}
+
+	SECTION("Defaults") {
+		const auto result = parse({"test-program", "lib"});
+		REQUIRE(!result.get<"verbose">());
+		REQUIRE(result.get<"jobs">().value_or(1) == 1);
+		REQUIRE(result.get<"define">().empty());
+		REQUIRE(result.extra_args().empty());
+	}
+
+	SECTION("Reused result") {
+		Schema::Result result;
+		const std::vector<const char *> first{"test-program", "-D", "x", "-v", "a"};
+		const std::vector<const char *> second{"test-program", "b"};
+		Schema::parse(first.size(), first.data(), result);
+		Schema::parse(second.size(), second.data(), result);
+		REQUIRE(!result.get<"verbose">());
+		REQUIRE(result.get<"define">().empty());
+		REQUIRE(result.get<"target">() == "b");
+	}
+
+	SECTION("Flag clusters") {
+		auto result = parse({"test-program", "-vj", "3", "all"});
+		REQUIRE(result.get<"verbose">());
+		REQUIRE(result.get<"jobs">() == 3);
+		result = parse({"test-program", "-j8", "-DX=1", "-vD-y", "all"});
+		REQUIRE(result.get<"jobs">() == 8);
+		REQUIRE(result.get<"define">() == std::vector<std::string>{"X=1", "-y"});
+		REQUIRE(result.get<"verbose">());
+		REQUIRE_THROWS_WITH(parse({"test-program", "-vx", "all"}), Equals("test-program: invalid flag '-x' in '-vx'"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "all", "-vj"}), Equals("test-program: 'jobs' requires a value"));
+	}
+
+	SECTION("Options end at the separator") {
+		const auto result = parse({"test-program", "t", "--", "-v", "--"});
+		REQUIRE(!result.get<"verbose">());
+		REQUIRE(result.get<"target">() == "t");
+		REQUIRE(result.extra_args().size() == 2);
+		REQUIRE(std::string{result.extra_args()[0]} == "-v");
+		REQUIRE(std::string{result.extra_args()[1]} == "--");
+		REQUIRE(parse({"test-program", "--", "-v"}).get<"target">() == "-v");
+	}
+
+	SECTION("Errors") {
+		REQUIRE_THROWS_WITH(parse({"test-program"}), Equals("test-program: requires positional argument 'target'"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "-x", "a"}), Equals("test-program: invalid flag '-x'"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "--bogus", "a"}), Equals("test-program: invalid option 'bogus'"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "--target", "a"}), Equals("test-program: invalid option 'target'"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "a", "-j"}), Equals("test-program: 'jobs' requires a value"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "a", "-j", "-v"}), Equals("test-program: 'jobs' requires a value"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "a", "-j", "1", "-j", "2"}), Equals("test-program: 'jobs' should only be specified once"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "a", "-v", "-v"}), Equals("test-program: 'verbose' should only be specified once"));
+		REQUIRE_THROWS_WITH(parse({"test-program", "a", "-j", "x"}), Equals("test-program: 'jobs' must be of integral type"));
+	}
+}
+
+TEST_CASE("Static_Schema perfect hash") {
+	using Many = Static_Schema<
+			Static_Optional<"opt00">, Static_Optional<"opt01">, Static_Optional<"opt02">, Static_Optional<"opt03">,
+			Static_Optional<"opt04">, Static_Optional<"opt05">, Static_Optional<"opt06">, Static_Optional<"opt07">,
+			Static_Optional<"opt08">, Static_Optional<"opt09">, Static_Optional<"opt10">, Static_Optional<"opt11">,
+			Static_Optional<"opt12">, Static_Optional<"opt13">, Static_Optional<"opt14">, Static_Optional<"opt15">,
+			Static_Optional<"opt16">, Static_Optional<"opt17">, Static_Optional<"opt18">, Static_Optional<"opt19">>;
+	const std::vector<const char *> args{"test-program", "--opt00", "0", "--opt07", "7", "--opt19", "19"};
+	const auto result = Many::parse(args.size(), args.data());
+	REQUIRE(result.get<"opt00">() == "0");
+	REQUIRE(result.get<"opt07">() == "7");
+	REQUIRE(result.get<"opt19">() == "19");
+	REQUIRE(!result.get<"opt10">());
+	const std::vector<const char *> bogus{"test-program", "--opt20", "x"};
+	REQUIRE_THROWS_WITH(Many::parse(bogus.size(), bogus.data()), EndsWith("invalid option 'opt20'"));
+}
+#endif /* CPPARSE_HAS_STATIC_SCHEMA */